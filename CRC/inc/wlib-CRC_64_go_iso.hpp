@@ -21,6 +21,13 @@ namespace wlib::crc
 
     virtual used_type operator()(std::byte const* beg, std::byte const* end) noexcept override;
 
+    // crc of a message in which old_data was replaced by new_data, number_of_trailing_bytes bytes follow the changed
+    // range. costs a pass over the changed range plus a logarithmic shift instead of a pass over the whole message
+    static used_type patch(used_type                  crc,
+                           std::span<std::byte const> old_data,
+                           std::span<std::byte const> new_data,
+                           std::size_t                number_of_trailing_bytes) noexcept;
+
   private:
     static constexpr used_type output_msk = 0xFFFF'FFFF'FFFF'FFFF;
     static constexpr used_type init_value = 0xFFFF'FFFF'FFFF'FFFF;
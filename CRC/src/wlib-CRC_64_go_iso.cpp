@@ -1,5 +1,8 @@
 #include <wlib-CRC_64_go_iso.hpp>
 
+//
+#include <array>
+
 namespace wlib::crc
 {
   namespace
@@ -56,4 +59,50 @@ namespace wlib::crc
 
     return this->get();
   }
+
+  namespace
+  {
+    constexpr uint64_t polynomial = 0xD800'0000'0000'0000;    // reflected x^64 + x^4 + x^3 + x + 1
+    constexpr uint64_t one        = 0x8000'0000'0000'0000;    // reflected x^0
+
+    // a * b mod polynomial, both reflected
+    constexpr uint64_t multiply(uint64_t a, uint64_t b) noexcept
+    {
+      uint64_t ret = 0;
+      for (uint64_t msk = one; msk != 0; msk >>= 1)
+      {
+        if ((a & msk) != 0)
+          ret ^= b;
+        b = (b & 1) != 0 ? (b >> 1) ^ polynomial : b >> 1;
+      }
+      return ret;
+    }
+
+    // x^(8 * 2^k) mod polynomial, shifting by 2^k zero bytes
+    constexpr auto byte_shift_table = []() {
+      std::array<uint64_t, 64> ret = {};
+      ret[0]                       = one >> 8;
+      for (std::size_t k = 1; k < ret.size(); ++k)
+        ret[k] = multiply(ret[k - 1], ret[k - 1]);
+      return ret;
+    }();
+  }    // namespace
+
+  CRC_64_go_iso::used_type CRC_64_go_iso::patch(used_type                  crc,
+                                                std::span<std::byte const> old_data,
+                                                std::span<std::byte const> new_data,
+                                                std::size_t                number_of_trailing_bytes) noexcept
+  {
+    // crcs of equally long messages are linear, the change is the crc of the xor without init and output mask
+    uint64_t delta = 0;
+    for (std::size_t i = 0; i < old_data.size() && i < new_data.size(); ++i)
+      delta = ((delta >> 8) & 0xFFFF'FFFF'FFFF'FF) ^ table[static_cast<uint8_t>((delta & 0xFF) ^ static_cast<uint8_t>(old_data[i] ^ new_data[i]))];
+
+    for (std::size_t k = 0; number_of_trailing_bytes != 0; number_of_trailing_bytes >>= 1, ++k)
+    {
+      if ((number_of_trailing_bytes & 1) != 0)
+        delta = multiply(byte_shift_table[k], delta);
+    }
+    return crc ^ delta;
+  }
 }    // namespace wlib::crc
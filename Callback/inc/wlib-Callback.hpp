@@ -2,8 +2,31 @@
 #ifndef WLIB_CALLBACK_HPP_INCLUDED
 #define WLIB_CALLBACK_HPP_INCLUDED
 
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
 namespace wlib
 {
+  namespace internal
+  {
+    [[noreturn]] void handle_empty_callback_exception();
+
+    // std::invoke_r of c++23, a void signature discards the result of the callable
+    template <typename R, typename F, typename... Args> constexpr R invoke_r(F&& fnc, Args&&... args)
+    {
+      if constexpr (std::is_void_v<R>)
+        std::invoke(std::forward<F>(fnc), std::forward<Args>(args)...);
+      else
+        return std::invoke(std::forward<F>(fnc), std::forward<Args>(args)...);
+    }
+  }
+
+  // the call operator takes the arguments as declared in the signature. implementations forward them, so a by value
+  // argument is moved once per layer instead of copied, for trivially copyable types that move is still a copy. large
+  // payloads are passed without any copy by declaring them as references, e.g. Callback<void(payload_t const&)>
   template <typename> class Callback;
   template <typename R, typename... Args> class Callback<R(Args...)>
   {
@@ -28,7 +51,7 @@ namespace wlib
     {
     }
 
-    R operator()(Args... args) override { return this->m_fnc(args...); }
+    R operator()(Args... args) override { return this->m_fnc(std::forward<Args>(args)...); }
 
   private:
     fnc_t m_fnc;
@@ -37,30 +60,47 @@ namespace wlib
 
 namespace wlib
 {
+  // the deduction guides pick Memberfunction_Callback<const T, ...> for Memberfunction_Callback{ obj, &T::const_fnc },
+  // which holds and calls a const member pointer directly. Memberfunction_Callback<T, ...> keeps either kind in a union
+  // and calls through a thunk that knows the active member
   template <typename, typename> class Memberfunction_Callback;
   template <typename T, typename R, typename... Args> class Memberfunction_Callback<T, R(Args...)> final: public Callback<R(Args...)>
   {
     using mem_fnc_t       = R (T::*)(Args...);
     using const_mem_fnc_t = R (T::*)(Args...) const;
 
+    union fnc_t
+    {
+      mem_fnc_t       mem;
+      const_mem_fnc_t const_mem;
+    };
+
+    using call_t = R (*)(T&, fnc_t const&, Args&&...);
+
+    static R call_mem(T& obj, fnc_t const& fnc, Args&&... args) { return (obj.*fnc.mem)(std::forward<Args>(args)...); }
+    static R call_const_mem(T& obj, fnc_t const& fnc, Args&&... args) { return (obj.*fnc.const_mem)(std::forward<Args>(args)...); }
+
   public:
     constexpr Memberfunction_Callback(T& obj, mem_fnc_t mem_fuc)
         : m_obj(obj)
-        , m_mem_fuc(mem_fuc)
+        , m_fnc{ .mem = mem_fuc }
+        , m_call{ &Memberfunction_Callback::call_mem }
     {
     }
 
     constexpr Memberfunction_Callback(T& obj, const_mem_fnc_t mem_fuc)
         : m_obj(obj)
-        , m_mem_fuc(reinterpret_cast<mem_fnc_t>(mem_fuc))
+        , m_fnc{ .const_mem = mem_fuc }
+        , m_call{ &Memberfunction_Callback::call_const_mem }
     {
     }
 
-    R operator()(Args... args) override { return (this->m_obj.*m_mem_fuc)(args...); }
+    R operator()(Args... args) override { return this->m_call(this->m_obj, this->m_fnc, std::forward<Args>(args)...); }
 
   private:
-    T&        m_obj;
-    mem_fnc_t m_mem_fuc;
+    T&     m_obj;
+    fnc_t  m_fnc;
+    call_t m_call;
   };
 
   template <typename T, typename R, typename... Args> class Memberfunction_Callback<const T, R(Args...)> final: public Callback<R(Args...)>
@@ -74,12 +114,181 @@ namespace wlib
     {
     }
 
-    R operator()(Args... args) override { return (this->m_obj.*m_mem_fuc)(args...); }
+    R operator()(Args... args) override { return (this->m_obj.*m_mem_fuc)(std::forward<Args>(args)...); }
 
   private:
     T const&        m_obj;
     const_mem_fnc_t m_mem_fuc;
   };
+
+  template <typename T, typename R, typename... Args> Memberfunction_Callback(T&, R (T::*)(Args...)) -> Memberfunction_Callback<T, R(Args...)>;
+  template <typename T, typename R, typename... Args> Memberfunction_Callback(T const&, R (T::*)(Args...) const) -> Memberfunction_Callback<const T, R(Args...)>;
+}    // namespace wlib
+
+namespace wlib
+{
+  // object pointer plus a trampoline generated for a compile time bound function, e.g. delegate<void(int)>::bind<&T::fnc>(obj).
+  // a call is a single indirect call, the target is inlined into the trampoline
+  template <typename> class delegate;
+  template <typename R, typename... Args> class delegate<R(Args...)>
+  {
+    using trampoline_t = R (*)(void*, Args&&...);
+
+    static R invoke_empty(void*, Args&&...) { internal::handle_empty_callback_exception(); }
+
+  public:
+    constexpr delegate() noexcept = default;
+
+    template <auto Fnc, typename T>
+      requires(std::is_member_function_pointer_v<decltype(Fnc)> && std::is_invocable_r_v<R, decltype(Fnc), T&, Args...>)
+    [[nodiscard]] static constexpr delegate bind(T& obj) noexcept
+    {
+      return delegate{ const_cast<void*>(static_cast<void const*>(&obj)),
+                       [](void* o, Args&&... args) -> R { return internal::invoke_r<R>(Fnc, *static_cast<T*>(o), std::forward<Args>(args)...); } };
+    }
+
+    template <auto Fnc>
+      requires(!std::is_member_function_pointer_v<decltype(Fnc)> && std::is_invocable_r_v<R, decltype(Fnc), Args...>)
+    [[nodiscard]] static constexpr delegate bind() noexcept
+    {
+      return delegate{ nullptr, [](void*, Args&&... args) -> R { return internal::invoke_r<R>(Fnc, std::forward<Args>(args)...); } };
+    }
+
+    R operator()(Args... args) const { return this->m_fnc(this->m_obj, std::forward<Args>(args)...); }
+
+    explicit constexpr operator bool() const noexcept { return this->m_fnc != &delegate::invoke_empty; }
+    constexpr bool operator==(delegate const&) const noexcept = default;
+
+  private:
+    constexpr delegate(void* obj, trampoline_t fnc) noexcept
+        : m_obj{ obj }
+        , m_fnc{ fnc }
+    {
+    }
+
+    void*        m_obj = nullptr;
+    trampoline_t m_fnc = &delegate::invoke_empty;
+  };
+
+  template <typename> class Delegate_Callback;
+  template <typename R, typename... Args> class Delegate_Callback<R(Args...)> final: public Callback<R(Args...)>
+  {
+  public:
+    constexpr Delegate_Callback(delegate<R(Args...)> fnc) noexcept
+        : m_fnc{ fnc }
+    {
+    }
+
+    R operator()(Args... args) override { return this->m_fnc(std::forward<Args>(args)...); }
+
+  private:
+    delegate<R(Args...)> m_fnc;
+  };
+}    // namespace wlib
+
+namespace wlib
+{
+  // stores any callable inline without allocation, a call is a single indirect call through the stored invoker.
+  // it is a Callback itself, so it can be handed to every consumer of Callback&
+  template <typename, std::size_t Capacity = 3 * sizeof(void*)> class inplace_function;
+  template <typename R, typename... Args, std::size_t Capacity> class inplace_function<R(Args...), Capacity> final: public Callback<R(Args...)>
+  {
+    using invoke_t = R (*)(void*, Args&&...);
+
+    struct ops_t
+    {
+      void (*copy)(void* dst, void const* src);
+      void (*move)(void* dst, void* src);
+      void (*destroy)(void* obj) noexcept;
+    };
+
+    template <typename F> static R invoke(void* obj, Args&&... args) { return internal::invoke_r<R>(*static_cast<F*>(obj), std::forward<Args>(args)...); }
+
+    static R invoke_empty(void*, Args&&...) { internal::handle_empty_callback_exception(); }
+
+    template <typename F>
+    static constexpr ops_t ops = {
+      .copy    = [](void* dst, void const* src) { ::new (dst) F(*static_cast<F const*>(src)); },
+      .move    = [](void* dst, void* src) { ::new (dst) F(std::move(*static_cast<F*>(src))); },
+      .destroy = [](void* obj) noexcept { static_cast<F*>(obj)->~F(); },
+    };
+
+  public:
+    inplace_function() noexcept = default;
+
+    template <typename Tfnc, typename F = std::decay_t<Tfnc>>
+      requires(!std::is_same_v<F, inplace_function> && std::is_copy_constructible_v<F> && std::is_invocable_r_v<R, F&, Args...>)
+    inplace_function(Tfnc&& fnc)
+    {
+      static_assert(sizeof(F) <= Capacity, "callable does not fit into the inplace_function");
+      static_assert(alignof(F) <= alignof(std::max_align_t), "callable is over aligned");
+
+      ::new (&this->m_storage) F(std::forward<Tfnc>(fnc));
+      this->m_invoke = &inplace_function::invoke<F>;
+      this->m_ops    = &inplace_function::ops<F>;
+    }
+
+    inplace_function(inplace_function const& other)
+        : m_invoke{ other.m_invoke }
+        , m_ops{ other.m_ops }
+    {
+      if (this->m_ops != nullptr)
+        this->m_ops->copy(&this->m_storage, &other.m_storage);
+    }
+
+    inplace_function(inplace_function&& other)
+        : m_invoke{ other.m_invoke }
+        , m_ops{ other.m_ops }
+    {
+      if (this->m_ops != nullptr)
+        this->m_ops->move(&this->m_storage, &other.m_storage);
+    }
+
+    inplace_function& operator=(inplace_function const& other)
+    {
+      if (this != &other)
+      {
+        this->reset();
+        if (other.m_ops != nullptr)
+          other.m_ops->copy(&this->m_storage, &other.m_storage);
+        this->m_invoke = other.m_invoke;
+        this->m_ops    = other.m_ops;
+      }
+      return *this;
+    }
+
+    inplace_function& operator=(inplace_function&& other)
+    {
+      if (this != &other)
+      {
+        this->reset();
+        if (other.m_ops != nullptr)
+          other.m_ops->move(&this->m_storage, &other.m_storage);
+        this->m_invoke = other.m_invoke;
+        this->m_ops    = other.m_ops;
+      }
+      return *this;
+    }
+
+    ~inplace_function() override { this->reset(); }
+
+    void reset() noexcept
+    {
+      if (this->m_ops != nullptr)
+        this->m_ops->destroy(&this->m_storage);
+      this->m_invoke = &inplace_function::invoke_empty;
+      this->m_ops    = nullptr;
+    }
+
+    explicit operator bool() const noexcept { return this->m_ops != nullptr; }
+
+    R operator()(Args... args) override { return this->m_invoke(&this->m_storage, std::forward<Args>(args)...); }
+
+  private:
+    alignas(std::max_align_t) std::byte m_storage[Capacity];
+    invoke_t                             m_invoke = &inplace_function::invoke_empty;
+    ops_t const*                         m_ops    = nullptr;
+  };
 }    // namespace wlib
 
 #endif
@@ -1 +1,9 @@
 #include <wlib-Callback.hpp>
+
+//
+#include <functional>
+
+namespace wlib
+{
+  void internal::handle_empty_callback_exception() { throw std::bad_function_call(); }
+}    // namespace wlib
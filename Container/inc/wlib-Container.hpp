@@ -2,15 +2,89 @@
 #ifndef WLIB_CONTAINER_HPP_INCLUDED
 #define WLIB_CONTAINER_HPP_INCLUDED
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iterator>
-#include <optional>
-#include <atomic>
 #include <new>
+#include <optional>
+#include <span>
+#include <type_traits>
 
 namespace wlib::container
 {
+  namespace internal
+  {
+    template <typename T>
+    using accumulate_t =
+        std::conditional_t<std::is_floating_point_v<T>, std::common_type_t<T, double>, std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>>;
+
+    template <typename T> using moment_t = std::common_type_t<T, double>;
+
+    // the reductions use four independent lanes so the compiler is free to vectorize them
+    template <typename T> constexpr accumulate_t<T> span_sum(std::span<T const> data) noexcept
+    {
+      accumulate_t<T> acc[4] = {};
+      std::size_t     i      = 0;
+      for (; i + 4 <= data.size(); i += 4)
+      {
+        acc[0] += data[i + 0];
+        acc[1] += data[i + 1];
+        acc[2] += data[i + 2];
+        acc[3] += data[i + 3];
+      }
+      for (; i < data.size(); ++i)
+        acc[0] += data[i];
+      return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    }
+
+    template <typename T> constexpr moment_t<T> span_sum_of_squared_deviation(std::span<T const> data, moment_t<T> mean) noexcept
+    {
+      moment_t<T> acc[4] = {};
+      std::size_t i      = 0;
+      for (; i + 4 <= data.size(); i += 4)
+      {
+        moment_t<T> const d0 = static_cast<moment_t<T>>(data[i + 0]) - mean;
+        moment_t<T> const d1 = static_cast<moment_t<T>>(data[i + 1]) - mean;
+        moment_t<T> const d2 = static_cast<moment_t<T>>(data[i + 2]) - mean;
+        moment_t<T> const d3 = static_cast<moment_t<T>>(data[i + 3]) - mean;
+        acc[0] += d0 * d0;
+        acc[1] += d1 * d1;
+        acc[2] += d2 * d2;
+        acc[3] += d3 * d3;
+      }
+      for (; i < data.size(); ++i)
+      {
+        moment_t<T> const d = static_cast<moment_t<T>>(data[i]) - mean;
+        acc[0] += d * d;
+      }
+      return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    }
+
+    template <typename T, typename Tcmp> constexpr T span_select(std::span<T const> data, T init, Tcmp cmp) noexcept
+    {
+      T           acc[4] = { init, init, init, init };
+      std::size_t i      = 0;
+      for (; i + 4 <= data.size(); i += 4)
+      {
+        acc[0] = cmp(data[i + 0], acc[0]) ? data[i + 0] : acc[0];
+        acc[1] = cmp(data[i + 1], acc[1]) ? data[i + 1] : acc[1];
+        acc[2] = cmp(data[i + 2], acc[2]) ? data[i + 2] : acc[2];
+        acc[3] = cmp(data[i + 3], acc[3]) ? data[i + 3] : acc[3];
+      }
+      for (; i < data.size(); ++i)
+        acc[0] = cmp(data[i], acc[0]) ? data[i] : acc[0];
+
+      acc[0] = cmp(acc[1], acc[0]) ? acc[1] : acc[0];
+      acc[2] = cmp(acc[3], acc[2]) ? acc[3] : acc[2];
+      return cmp(acc[2], acc[0]) ? acc[2] : acc[0];
+    }
+  }    // namespace internal
+
   template <typename T, std::size_t N>
     requires(N > 0 && std::is_destructible_v<T> && std::is_default_constructible_v<T> && std::is_copy_assignable_v<T>)
   class circular_buffer_t
@@ -74,6 +148,10 @@ namespace wlib::container
     static_assert(std::sentinel_for<sentinel, iterator>);
 
   public:
+    using span_t       = std::span<payload_t const>;
+    using accumulate_t = internal::accumulate_t<payload_t>;
+    using moment_t     = internal::moment_t<payload_t>;
+
     circular_buffer_t() = default;
 
     constexpr void push(payload_t const& value) noexcept
@@ -125,7 +203,69 @@ namespace wlib::container
     auto begin() const -> iterator { return iterator{ *this, 0, this->occupied_entries() }; }
     auto end() const -> sentinel { return sentinel{}; }
 
+    // oldest entries first, the second span is empty if the content does not wrap around
+    constexpr std::array<span_t, 2> as_spans() const noexcept
+    {
+      if (this->m_r_idx <= this->m_w_idx)
+        return { span_t(this->m_values + this->m_r_idx, this->m_w_idx - this->m_r_idx), span_t() };
+      return { span_t(this->m_values + this->m_r_idx, buffer_length - this->m_r_idx), span_t(this->m_values, this->m_w_idx) };
+    }
+
+    constexpr accumulate_t sum() const noexcept
+      requires(std::is_arithmetic_v<payload_t>)
+    {
+      auto const spans = this->as_spans();
+      return internal::span_sum(spans[0]) + internal::span_sum(spans[1]);
+    }
+
+    constexpr std::optional<payload_t> minimum() const noexcept
+      requires(std::is_arithmetic_v<payload_t>)
+    {
+      return this->select([](payload_t const& lhs, payload_t const& rhs) { return lhs < rhs; });
+    }
+
+    constexpr std::optional<payload_t> maximum() const noexcept
+      requires(std::is_arithmetic_v<payload_t>)
+    {
+      return this->select([](payload_t const& lhs, payload_t const& rhs) { return rhs < lhs; });
+    }
+
+    constexpr moment_t mean() const noexcept
+      requires(std::is_arithmetic_v<payload_t>)
+    {
+      std::size_t const n = this->occupied_entries();
+      if (n == 0)
+        return moment_t{};
+      return static_cast<moment_t>(this->sum()) / static_cast<moment_t>(n);
+    }
+
+    // population variance
+    constexpr moment_t variance() const noexcept
+      requires(std::is_arithmetic_v<payload_t>)
+    {
+      std::size_t const n = this->occupied_entries();
+      if (n == 0)
+        return moment_t{};
+
+      moment_t const mean  = this->mean();
+      auto const     spans = this->as_spans();
+      return (internal::span_sum_of_squared_deviation(spans[0], mean) + internal::span_sum_of_squared_deviation(spans[1], mean)) /
+             static_cast<moment_t>(n);
+    }
+
   private:
+    template <typename Tcmp> constexpr std::optional<payload_t> select(Tcmp cmp) const noexcept
+    {
+      auto const spans = this->as_spans();
+      if (spans[0].empty())
+        return std::nullopt;
+
+      payload_t const ret = internal::span_select(spans[0], spans[0].front(), cmp);
+      if (spans[1].empty())
+        return ret;
+      return internal::span_select(spans[1], ret, cmp);
+    }
+
     static constexpr std::size_t increment_index(std::size_t idx) noexcept
     {
       if (++idx == buffer_length)
@@ -145,6 +285,127 @@ namespace wlib::container
     payload_t   m_values[buffer_length] = {};
   };
 
+  // circular buffer that keeps sum, mean and variance of its content up to date on every push
+  template <typename T, std::size_t N>
+    requires(std::is_arithmetic_v<T>)
+  class running_circular_buffer_t
+  {
+    using buffer_t = circular_buffer_t<T, N>;
+
+  public:
+    using payload_t    = T;
+    using span_t       = typename buffer_t::span_t;
+    using accumulate_t = typename buffer_t::accumulate_t;
+    using moment_t     = typename buffer_t::moment_t;
+
+    running_circular_buffer_t() = default;
+
+    constexpr void push(payload_t const& value) noexcept
+    {
+      if (this->m_buffer.occupied_entries() == this->m_buffer.capacity())
+        this->p_replace(this->m_buffer.as_spans()[0].front(), value);
+      else
+        this->p_add(value);
+
+      this->m_buffer.push(value);
+    }
+
+    constexpr std::size_t capacity() const noexcept { return this->m_buffer.capacity(); }
+    constexpr std::size_t occupied_entries() const noexcept { return this->m_buffer.occupied_entries(); }
+
+    payload_t const& operator[](std::size_t idx) const noexcept { return this->m_buffer[idx]; }
+
+    void clear() noexcept
+    {
+      this->m_buffer.clear();
+      this->m_sum  = accumulate_t{};
+      this->m_mean = moment_t{};
+      this->m_m2   = moment_t{};
+    }
+
+    void keep_last(std::size_t keep)
+    {
+      if (keep == 0)
+        return this->clear();
+
+      std::size_t n = this->occupied_entries();
+      for (span_t const& span : this->m_buffer.as_spans())
+      {
+        for (std::size_t i = 0; i < span.size() && n > keep; ++i, --n)
+          this->p_remove(span[i], n);
+      }
+
+      this->m_buffer.keep_last(keep);
+    }
+
+    auto begin() const { return this->m_buffer.begin(); }
+    auto end() const { return this->m_buffer.end(); }
+
+    constexpr std::array<span_t, 2> as_spans() const noexcept { return this->m_buffer.as_spans(); }
+
+    constexpr accumulate_t             sum() const noexcept { return this->m_sum; }
+    constexpr moment_t                 mean() const noexcept { return this->m_mean; }
+    constexpr std::optional<payload_t> minimum() const noexcept { return this->m_buffer.minimum(); }
+    constexpr std::optional<payload_t> maximum() const noexcept { return this->m_buffer.maximum(); }
+
+    // population variance
+    constexpr moment_t variance() const noexcept
+    {
+      std::size_t const n = this->occupied_entries();
+      if (n == 0 || this->m_m2 <= moment_t{})
+        return moment_t{};
+      return this->m_m2 / static_cast<moment_t>(n);
+    }
+
+  private:
+    constexpr void p_add(payload_t const& value) noexcept
+    {
+      moment_t const n     = static_cast<moment_t>(this->occupied_entries() + 1);
+      moment_t const x     = static_cast<moment_t>(value);
+      moment_t const delta = x - this->m_mean;
+
+      this->m_sum += value;
+      this->m_mean += delta / n;
+      this->m_m2 += delta * (x - this->m_mean);
+    }
+
+    constexpr void p_replace(payload_t const& old_value, payload_t const& new_value) noexcept
+    {
+      moment_t const n        = static_cast<moment_t>(this->occupied_entries());
+      moment_t const x_old    = static_cast<moment_t>(old_value);
+      moment_t const x_new    = static_cast<moment_t>(new_value);
+      moment_t const old_mean = this->m_mean;
+
+      this->m_sum -= old_value;
+      this->m_sum += new_value;
+      this->m_mean += (x_new - x_old) / n;
+      this->m_m2 += (x_new - x_old) * (x_new - this->m_mean + x_old - old_mean);
+    }
+
+    constexpr void p_remove(payload_t const& value, std::size_t n) noexcept
+    {
+      if (n <= 1)
+      {
+        this->m_sum  = accumulate_t{};
+        this->m_mean = moment_t{};
+        this->m_m2   = moment_t{};
+        return;
+      }
+
+      moment_t const x        = static_cast<moment_t>(value);
+      moment_t const old_mean = this->m_mean;
+
+      this->m_sum -= value;
+      this->m_mean -= (x - old_mean) / static_cast<moment_t>(n - 1);
+      this->m_m2 -= (x - old_mean) * (x - this->m_mean);
+    }
+
+    buffer_t     m_buffer = {};
+    accumulate_t m_sum    = {};
+    moment_t     m_mean   = {};
+    moment_t     m_m2     = {};
+  };
+
   template <typename T, std::size_t N>
     requires(N > 0 && std::is_destructible_v<T> && (std::is_copy_constructible_v<T> || std::is_move_constructible_v<T>))
   class SPSC
@@ -291,6 +552,163 @@ namespace wlib::container
     std::atomic<std::size_t> m_r_idx = 0;
   };
 
+  namespace internal
+  {
+    // takes the error code explicitly, the cleanup before the throw may change errno
+    void handle_mapping_exception(int error);
+
+    class byte_ring_t
+    {
+    public:
+      byte_ring_t(byte_ring_t const&)            = delete;
+      byte_ring_t(byte_ring_t&&)                 = delete;
+      byte_ring_t& operator=(byte_ring_t const&) = delete;
+      byte_ring_t& operator=(byte_ring_t&&)      = delete;
+
+      // producer side, the span covers all free bytes if the memory is mirrored, otherwise it ends at the wrap around
+      std::span<std::byte> get_write_span() noexcept
+      {
+        std::size_t const w    = this->m_w_idx.load(std::memory_order_relaxed);
+        std::size_t const free = this->free_bytes(this->m_r_idx.load(std::memory_order_acquire), w);
+        return { this->m_mem + w, this->m_is_mirrored ? free : std::min(free, this->m_len - w) };
+      }
+
+      void commit_write(std::size_t number_of_bytes) noexcept
+      {
+        this->m_w_idx.store(this->advance(this->m_w_idx.load(std::memory_order_relaxed), number_of_bytes), std::memory_order_release);
+      }
+
+      bool try_write(std::span<std::byte const> data) noexcept
+      {
+        std::size_t const w = this->m_w_idx.load(std::memory_order_relaxed);
+        if (this->free_bytes(this->m_r_idx.load(std::memory_order_acquire), w) < data.size())
+          return false;
+
+        this->copy_to(w, data);
+        this->commit_write(data.size());
+        return true;
+      }
+
+      // consumer side, the span covers all used bytes if the memory is mirrored, otherwise it ends at the wrap around
+      std::span<std::byte const> get_read_span() const noexcept
+      {
+        std::size_t const r    = this->m_r_idx.load(std::memory_order_relaxed);
+        std::size_t const used = this->used_bytes(r, this->m_w_idx.load(std::memory_order_acquire));
+        return { this->m_mem + r, this->m_is_mirrored ? used : std::min(used, this->m_len - r) };
+      }
+
+      void commit_read(std::size_t number_of_bytes) noexcept
+      {
+        this->m_r_idx.store(this->advance(this->m_r_idx.load(std::memory_order_relaxed), number_of_bytes), std::memory_order_release);
+      }
+
+      bool try_read(std::span<std::byte> data) noexcept
+      {
+        std::size_t const r = this->m_r_idx.load(std::memory_order_relaxed);
+        if (this->used_bytes(r, this->m_w_idx.load(std::memory_order_acquire)) < data.size())
+          return false;
+
+        this->copy_from(r, data);
+        this->commit_read(data.size());
+        return true;
+      }
+
+      std::size_t get_number_of_bytes() const noexcept { return this->m_len - 1; }
+      std::size_t get_number_of_used_bytes() const noexcept { return this->used_bytes(this->m_r_idx.load(), this->m_w_idx.load()); }
+      std::size_t get_number_of_free_bytes() const noexcept { return this->free_bytes(this->m_r_idx.load(), this->m_w_idx.load()); }
+
+    protected:
+      // a mirrored memory has to provide 2 * memory.size() bytes, with the second half aliasing the first one
+      byte_ring_t(std::span<std::byte> memory, bool is_mirrored) noexcept
+          : m_mem{ memory.data() }
+          , m_len{ memory.size() }
+          , m_is_mirrored{ is_mirrored }
+      {
+      }
+      ~byte_ring_t() = default;
+
+    private:
+      std::size_t advance(std::size_t idx, std::size_t val) const noexcept
+      {
+        idx += val;
+        return idx >= this->m_len ? idx - this->m_len : idx;
+      }
+
+      std::size_t used_bytes(std::size_t r, std::size_t w) const noexcept { return r <= w ? w - r : this->m_len + w - r; }
+      std::size_t free_bytes(std::size_t r, std::size_t w) const noexcept { return this->m_len - 1 - this->used_bytes(r, w); }
+
+      void copy_to(std::size_t idx, std::span<std::byte const> data) noexcept
+      {
+        std::size_t const first = this->m_is_mirrored ? data.size() : std::min(data.size(), this->m_len - idx);
+        std::memcpy(this->m_mem + idx, data.data(), first);
+        std::memcpy(this->m_mem, data.data() + first, data.size() - first);
+      }
+
+      void copy_from(std::size_t idx, std::span<std::byte> data) const noexcept
+      {
+        std::size_t const first = this->m_is_mirrored ? data.size() : std::min(data.size(), this->m_len - idx);
+        std::memcpy(data.data(), this->m_mem + idx, first);
+        std::memcpy(data.data() + first, this->m_mem, data.size() - first);
+      }
+
+      std::byte*  m_mem;
+      std::size_t m_len;
+      bool        m_is_mirrored;
+
+      alignas(64) std::atomic<std::size_t> m_w_idx = 0;
+      alignas(64) std::atomic<std::size_t> m_r_idx = 0;
+    };
+
+#if defined(__linux__)
+    class mirrored_mapping_t
+    {
+    public:
+      explicit mirrored_mapping_t(std::size_t min_size);
+      mirrored_mapping_t(mirrored_mapping_t const&)            = delete;
+      mirrored_mapping_t(mirrored_mapping_t&&)                 = delete;
+      mirrored_mapping_t& operator=(mirrored_mapping_t const&) = delete;
+      mirrored_mapping_t& operator=(mirrored_mapping_t&&)      = delete;
+      ~mirrored_mapping_t();
+
+      std::span<std::byte> get_span() const noexcept { return { this->m_mem, this->m_len }; }
+
+    private:
+      std::byte*  m_mem = nullptr;
+      std::size_t m_len = 0;
+    };
+#endif
+  }    // namespace internal
+
+  // lock-free single producer single consumer ring for variable length byte streams
+  template <std::size_t N>
+    requires(N > 0)
+  class SPSC_byte_ring final: public internal::byte_ring_t
+  {
+  public:
+    SPSC_byte_ring() noexcept
+        : internal::byte_ring_t({ this->m_mem, N + 1 }, false)
+    {
+    }
+
+  private:
+    std::byte m_mem[N + 1];
+  };
+
+#if defined(__linux__)
+  // the ring memory is mapped twice back to back, so read and write spans never wrap around
+  class mirrored_SPSC_byte_ring final
+      : private internal::mirrored_mapping_t
+      , public internal::byte_ring_t
+  {
+  public:
+    explicit mirrored_SPSC_byte_ring(std::size_t min_size)
+        : internal::mirrored_mapping_t(min_size + 1)
+        , internal::byte_ring_t(this->get_span(), true)
+    {
+    }
+  };
+#endif
+
 }    // namespace wlib::container
 
 #endif    // !WLIB_CRC_INTERFACE_HPP
@@ -3,3 +3,57 @@
 //
 #include <stdexcept>
 
+#if defined(__linux__)
+#include <cerrno>
+#include <system_error>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace wlib::container
+{
+#if defined(__linux__)
+  void internal::handle_mapping_exception(int error) { throw std::system_error(error, std::generic_category(), "unable to create mirrored mapping"); }
+
+  internal::mirrored_mapping_t::mirrored_mapping_t(std::size_t min_size)
+  {
+    std::size_t const page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::size_t const len  = (min_size + page - 1) / page * page;
+
+    int const fd = ::memfd_create("wlib-byte-ring", MFD_CLOEXEC);
+    if (fd < 0)
+      handle_mapping_exception(errno);
+
+    if (::ftruncate(fd, static_cast<off_t>(len)) != 0)
+    {
+      int const error = errno;
+      ::close(fd);
+      handle_mapping_exception(error);
+    }
+
+    void* const base = ::mmap(nullptr, 2 * len, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+    {
+      int const error = errno;
+      ::close(fd);
+      handle_mapping_exception(error);
+    }
+
+    std::byte* const mem = static_cast<std::byte*>(base);
+    if (::mmap(mem, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+        ::mmap(mem + len, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+      int const error = errno;
+      ::munmap(base, 2 * len);
+      ::close(fd);
+      handle_mapping_exception(error);
+    }
+
+    ::close(fd);
+    this->m_mem = mem;
+    this->m_len = len;
+  }
+
+  internal::mirrored_mapping_t::~mirrored_mapping_t() { ::munmap(this->m_mem, 2 * this->m_len); }
+#endif
+}    // namespace wlib::container
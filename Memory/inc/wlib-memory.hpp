@@ -9,6 +9,12 @@ namespace wlib
 {
   namespace memory
   {
+    namespace internal
+    {
+      void handle_range_exception();
+      void handle_configuration_exception(char const* what);
+    }    // namespace internal
+
     class Non_Volatile_Memory_Interface
     {
     public:
@@ -0,0 +1,191 @@
+#pragma once
+#ifndef WLIB_MEMORY_ASYNC_HPP_INCLUDED
+#define WLIB_MEMORY_ASYNC_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <wlib-Callback.hpp>
+#include <wlib-memory.hpp>
+
+namespace wlib::memory
+{
+  class io_request_t;
+  class Async_Non_Volatile_Memory_Interface;
+
+  using io_completion_t = wlib::Callback<void(io_request_t&)>;
+
+  enum class io_status_t : std::uint8_t
+  {
+    idle,
+    queued,
+    in_flight,
+    done,
+    failed,
+  };
+
+  // completion token of one asynchronous operation. it is owned by the caller and together with its buffer it has to
+  // stay alive until the request is done or failed
+  class io_request_t
+  {
+  public:
+    io_request_t() = default;
+    explicit io_request_t(io_completion_t& on_complete) noexcept
+        : m_on_complete{ &on_complete }
+    {
+    }
+    io_request_t(io_request_t const&)            = delete;
+    io_request_t(io_request_t&&)                 = delete;
+    io_request_t& operator=(io_request_t const&) = delete;
+    io_request_t& operator=(io_request_t&&)      = delete;
+    ~io_request_t()                              = default;
+
+    io_status_t get_status() const noexcept { return this->m_status.load(std::memory_order_acquire); }
+    bool        is_pending() const noexcept { return this->get_status() == io_status_t::queued || this->get_status() == io_status_t::in_flight; }
+
+    // number of transferred bytes or the negative errno of a failed request
+    std::int64_t get_result() const noexcept { return this->m_result; }
+
+  private:
+    enum class op_t : std::uint8_t
+    {
+      read,
+      write,
+      flush,
+    };
+
+    friend Async_Non_Volatile_Memory_Interface;
+
+    io_completion_t*         m_on_complete = nullptr;
+    std::atomic<io_status_t> m_status      = io_status_t::idle;
+    op_t                     m_op          = op_t::read;
+    std::size_t              m_add         = 0;
+    std::byte*               m_data        = nullptr;
+    std::size_t              m_size        = 0;
+    std::int64_t             m_result      = 0;
+    io_request_t*            m_next        = nullptr;
+  };
+
+  // submit_*() only queue a request, commit() hands all queued requests to the device as one batch. completions are
+  // reported by poll() and wait() on the calling thread, a flush completes after every write committed before it.
+  // a single thread is expected to drive an instance
+  class Async_Non_Volatile_Memory_Interface
+  {
+  public:
+    virtual ~Async_Non_Volatile_Memory_Interface() = default;
+
+    virtual std::size_t capacity() const  = 0;
+    virtual std::size_t alignment() const = 0;
+
+    void submit_read(io_request_t& req, std::size_t add, std::span<std::byte> data);
+    void submit_write(io_request_t& req, std::size_t add, std::span<std::byte const> data);
+    void submit_flush(io_request_t& req);
+
+    // returns the number of requests handed to the device
+    std::size_t commit();
+    // reports finished requests without blocking, returns their number
+    std::size_t poll();
+    // commits outstanding requests and blocks until req is finished
+    void        wait(io_request_t& req);
+    // commits outstanding requests and blocks until every request is finished
+    void        drain();
+
+    std::size_t get_number_of_in_flight_requests() const noexcept { return this->m_number_of_in_flight; }
+
+  protected:
+    using op_t = io_request_t::op_t;
+
+    struct request_view_t
+    {
+      op_t        op;
+      std::size_t add;
+      std::byte*  data;
+      std::size_t size;
+    };
+
+    // queues one request in submission order, do_commit() hands the queued requests to the device
+    virtual void do_submit(io_request_t& req, request_view_t const& view) = 0;
+    virtual void do_commit()                                              = 0;
+    // has to call complete() for every finished request, blocks for at least one if blocking is set
+    virtual void do_reap(bool blocking) = 0;
+
+    void complete(io_request_t& req, std::int64_t result);
+
+  private:
+    void p_queue(io_request_t& req, op_t op, std::size_t add, std::byte* data, std::size_t size);
+
+    io_request_t* m_first               = nullptr;
+    io_request_t* m_last                = nullptr;
+    std::size_t   m_number_of_completed = 0;
+    std::size_t   m_number_of_in_flight = 0;
+  };
+
+  // runs the requests of a synchronous memory on commit, e.g. to drive a storage written against the async interface
+  class async_memory_adapter_t final: public Async_Non_Volatile_Memory_Interface
+  {
+  public:
+    explicit async_memory_adapter_t(Non_Volatile_Memory_Interface& mem) noexcept
+        : m_mem{ mem }
+    {
+    }
+
+    std::size_t capacity() const override { return this->m_mem.capacity(); }
+    std::size_t alignment() const override { return this->m_mem.alignment(); }
+
+  private:
+    void do_submit(io_request_t& req, request_view_t const& view) override;
+    void do_commit() override {}
+    void do_reap(bool) override {}
+
+    Non_Volatile_Memory_Interface& m_mem;
+  };
+}    // namespace wlib::memory
+
+#if __has_include(<unistd.h>)
+
+namespace wlib::memory
+{
+  enum class io_backend_t : std::uint8_t
+  {
+    automatic,
+    io_uring,
+    thread_pool,
+  };
+
+  // file or block device accessed with io_uring. automatic falls back to a pool of pread/pwrite workers when the
+  // kernel refuses io_uring, e.g. older kernels or seccomp filtered containers
+  class async_file_memory_t final: public Async_Non_Volatile_Memory_Interface
+  {
+  public:
+    async_file_memory_t(char const* path, std::size_t capacity, std::size_t alignment = 1, io_backend_t backend = io_backend_t::automatic, std::size_t queue_depth = 64);
+    async_file_memory_t(async_file_memory_t const&)            = delete;
+    async_file_memory_t(async_file_memory_t&&)                 = delete;
+    async_file_memory_t& operator=(async_file_memory_t const&) = delete;
+    async_file_memory_t& operator=(async_file_memory_t&&)      = delete;
+    ~async_file_memory_t() override;
+
+    std::size_t capacity() const override { return this->m_capacity; }
+    std::size_t alignment() const override { return this->m_alignment; }
+
+    io_backend_t get_backend() const noexcept;
+
+  private:
+    class engine_t;
+    class uring_engine_t;
+    class pool_engine_t;
+
+    void do_submit(io_request_t& req, request_view_t const& view) override;
+    void do_commit() override;
+    void do_reap(bool blocking) override;
+
+    int                       m_fd        = -1;
+    std::size_t               m_capacity  = 0;
+    std::size_t               m_alignment = 1;
+    std::unique_ptr<engine_t> m_engine;
+  };
+}    // namespace wlib::memory
+
+#endif
+#endif    // WLIB_MEMORY_ASYNC_HPP_INCLUDED
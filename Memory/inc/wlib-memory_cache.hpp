@@ -0,0 +1,179 @@
+#pragma once
+#ifndef WLIB_MEMORY_CACHE_HPP_INCLUDED
+#define WLIB_MEMORY_CACHE_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <wlib-memory.hpp>
+
+namespace wlib::memory
+{
+  // write back cache with NumberOfPages LRU managed pages of PageSize bytes in front of a non volatile memory.
+  // small writes are collected in their page and reach the device as whole pages on eviction, on flush() or once
+  // dirty_threshold pages are dirty
+  template <std::size_t NumberOfPages, std::size_t PageSize>
+    requires(NumberOfPages > 0 && PageSize > 0)
+  class cached_memory_t final: public Non_Volatile_Memory_Interface
+  {
+  public:
+    cached_memory_t(Non_Volatile_Memory_Interface& mem, std::size_t dirty_threshold = NumberOfPages)
+        : m_mem{ mem }
+        , m_dirty_threshold{ std::clamp<std::size_t>(dirty_threshold, 1, NumberOfPages) }
+    {
+      if (PageSize % this->m_mem.alignment() != 0)
+        internal::handle_configuration_exception("page size is not a multiple of the memory alignment");
+    }
+    cached_memory_t(cached_memory_t const&)            = delete;
+    cached_memory_t(cached_memory_t&&)                 = delete;
+    cached_memory_t& operator=(cached_memory_t const&) = delete;
+    cached_memory_t& operator=(cached_memory_t&&)      = delete;
+    // writes the dirty pages back, errors are lost here, call flush() before to see them
+    ~cached_memory_t() override
+    {
+      try
+      {
+        this->flush();
+      }
+      catch (...)
+      {
+      }
+    }
+
+    std::size_t capacity() const override { return this->m_mem.capacity(); }
+    std::size_t alignment() const override { return this->m_mem.alignment(); }
+
+    void write(std::size_t add, std::span<std::byte const> data) override
+    {
+      this->range_check(add, data.size());
+      while (!data.empty())
+      {
+        std::size_t const offset = add % PageSize;
+        std::size_t const len    = std::min(data.size(), PageSize - offset);
+
+        page_t& page = this->p_get(add / PageSize, offset != 0 || len != this->page_length(add / PageSize));
+        std::memcpy(page.data + offset, data.data(), len);
+        if (!page.is_dirty)
+        {
+          page.is_dirty = true;
+          ++this->m_number_of_dirty_pages;
+        }
+
+        add += len;
+        data = data.subspan(len);
+      }
+
+      while (this->m_number_of_dirty_pages >= this->m_dirty_threshold)
+        this->p_write_back(this->p_oldest_dirty());
+    }
+
+    void flush() override
+    {
+      while (this->m_number_of_dirty_pages > 0)
+        this->p_write_back(this->p_lowest_dirty());
+      this->m_mem.flush();
+    }
+
+    void read(std::size_t add, std::span<std::byte> data) override
+    {
+      this->range_check(add, data.size());
+      while (!data.empty())
+      {
+        std::size_t const offset = add % PageSize;
+        std::size_t const len    = std::min(data.size(), PageSize - offset);
+
+        page_t& page = this->p_get(add / PageSize, true);
+        std::memcpy(data.data(), page.data + offset, len);
+
+        add += len;
+        data = data.subspan(len);
+      }
+    }
+
+    std::size_t get_number_of_dirty_pages() const noexcept { return this->m_number_of_dirty_pages; }
+
+  private:
+    struct page_t
+    {
+      std::size_t   idx      = 0;
+      std::uint64_t age      = 0;
+      bool          is_valid = false;
+      bool          is_dirty = false;
+      std::byte     data[PageSize];
+    };
+
+    void range_check(std::size_t add, std::size_t len) const
+    {
+      if (add > this->capacity() || len > this->capacity() - add)
+        internal::handle_range_exception();
+    }
+
+    std::size_t page_length(std::size_t idx) const { return std::min(PageSize, this->capacity() - idx * PageSize); }
+
+    page_t& p_get(std::size_t idx, bool needs_content)
+    {
+      page_t* victim = &this->m_pages[0];
+      for (page_t& page : this->m_pages)
+      {
+        if (page.is_valid && page.idx == idx)
+        {
+          page.age = ++this->m_tick;
+          return page;
+        }
+        if (victim->is_valid && (!page.is_valid || page.age < victim->age))
+          victim = &page;
+      }
+
+      if (victim->is_dirty)
+        this->p_write_back(*victim);
+
+      // the slot stays invalid until its content is complete, a failed read must not leave a stale page behind
+      victim->is_valid = false;
+      if (needs_content)
+        this->m_mem.read(idx * PageSize, std::span<std::byte>(victim->data, this->page_length(idx)));
+      victim->idx      = idx;
+      victim->is_valid = true;
+      victim->age      = ++this->m_tick;
+      return *victim;
+    }
+
+    page_t& p_oldest_dirty()
+    {
+      page_t* ret = nullptr;
+      for (page_t& page : this->m_pages)
+      {
+        if (page.is_dirty && (ret == nullptr || page.age < ret->age))
+          ret = &page;
+      }
+      return *ret;
+    }
+
+    page_t& p_lowest_dirty()
+    {
+      page_t* ret = nullptr;
+      for (page_t& page : this->m_pages)
+      {
+        if (page.is_dirty && (ret == nullptr || page.idx < ret->idx))
+          ret = &page;
+      }
+      return *ret;
+    }
+
+    void p_write_back(page_t& page)
+    {
+      this->m_mem.write(page.idx * PageSize, std::span<std::byte const>(page.data, this->page_length(page.idx)));
+      page.is_dirty = false;
+      --this->m_number_of_dirty_pages;
+    }
+
+    Non_Volatile_Memory_Interface& m_mem;
+    std::size_t                    m_dirty_threshold;
+    std::size_t                    m_number_of_dirty_pages = 0;
+    std::uint64_t                  m_tick                  = 0;
+    page_t                         m_pages[NumberOfPages]  = {};
+  };
+}    // namespace wlib::memory
+
+#endif    // WLIB_MEMORY_CACHE_HPP_INCLUDED
@@ -0,0 +1,47 @@
+#pragma once
+#ifndef WLIB_MEMORY_MAPPED_FILE_HPP_INCLUDED
+#define WLIB_MEMORY_MAPPED_FILE_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <wlib-memory.hpp>
+
+#if __has_include(<sys/mman.h>)
+
+namespace wlib::memory
+{
+  // host side non volatile memory backed by a memory mapped file, flush() only syncs the pages written since the last flush
+  class mapped_file_memory_t final: public Non_Volatile_Memory_Interface
+  {
+  public:
+    mapped_file_memory_t(char const* path, std::size_t capacity, std::size_t alignment = 1);
+    mapped_file_memory_t(mapped_file_memory_t const&)            = delete;
+    mapped_file_memory_t(mapped_file_memory_t&&)                 = delete;
+    mapped_file_memory_t& operator=(mapped_file_memory_t const&) = delete;
+    mapped_file_memory_t& operator=(mapped_file_memory_t&&)      = delete;
+    ~mapped_file_memory_t() override;
+
+    std::size_t capacity() const override { return this->m_capacity; }
+    std::size_t alignment() const override { return this->m_alignment; }
+    void        write(std::size_t add, std::span<std::byte const> data) override;
+    void        flush() override;
+    void        read(std::size_t add, std::span<std::byte> data) override;
+
+    std::size_t get_number_of_dirty_pages() const noexcept;
+
+  private:
+    void range_check(std::size_t add, std::size_t len) const;
+
+    int                        m_fd        = -1;
+    std::byte*                 m_mem       = nullptr;
+    std::size_t                m_capacity  = 0;
+    std::size_t                m_alignment = 1;
+    std::size_t                m_page_size = 1;
+    std::vector<std::uint64_t> m_dirty     = {};
+  };
+}    // namespace wlib::memory
+
+#endif
+#endif    // WLIB_MEMORY_MAPPED_FILE_HPP_INCLUDED
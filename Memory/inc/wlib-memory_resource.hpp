@@ -0,0 +1,137 @@
+#pragma once
+#ifndef WLIB_MEMORY_RESOURCE_HPP_INCLUDED
+#define WLIB_MEMORY_RESOURCE_HPP_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+
+namespace wlib::memory
+{
+  // monotonic allocator over a caller provided buffer. allocation is an atomic pointer bump, deallocation does
+  // nothing, release() frees everything at once. requests beyond the buffer go to upstream, those chunks carry a small
+  // header linking them, so release() and the destructor can return them
+  class arena_resource_t final: public std::pmr::memory_resource
+  {
+  public:
+    explicit arena_resource_t(std::span<std::byte> buffer, std::pmr::memory_resource* upstream = std::pmr::null_memory_resource()) noexcept
+        : m_buffer{ buffer }
+        , m_upstream{ upstream }
+    {
+    }
+    arena_resource_t(arena_resource_t const&)            = delete;
+    arena_resource_t(arena_resource_t&&)                 = delete;
+    arena_resource_t& operator=(arena_resource_t const&) = delete;
+    arena_resource_t& operator=(arena_resource_t&&)      = delete;
+    ~arena_resource_t() override;
+
+    // must not race with allocations
+    void release() noexcept;
+
+    std::size_t get_number_of_used_bytes() const noexcept { return this->m_offset.load(std::memory_order_relaxed); }
+    std::size_t get_number_of_free_bytes() const noexcept { return this->m_buffer.size() - this->get_number_of_used_bytes(); }
+
+  private:
+    struct chunk_t
+    {
+      chunk_t*    next;
+      std::size_t size;
+      std::size_t alignment;
+    };
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void  do_deallocate(void*, std::size_t, std::size_t) override {}
+    bool  do_is_equal(std::pmr::memory_resource const& other) const noexcept override { return this == &other; }
+
+    void* p_allocate_upstream(std::size_t bytes, std::size_t alignment);
+
+    std::span<std::byte>       m_buffer;
+    std::pmr::memory_resource* m_upstream;
+    std::atomic<std::size_t>   m_offset = 0;
+    std::atomic<chunk_t*>      m_chunks = nullptr;
+  };
+
+  // size class allocator over a caller provided buffer. blocks of power of two sizes between min_block_size and
+  // max_block_size are carved from the buffer on demand and recycled through one free list per class, larger requests
+  // go to upstream. a cache_t per thread takes blocks from the shared lists in batches and keeps the lock off the
+  // common path
+  class slab_resource_t final: public std::pmr::memory_resource
+  {
+  public:
+    static constexpr std::size_t min_block_size    = 8;
+    static constexpr std::size_t number_of_classes = 10;
+    static constexpr std::size_t max_block_size    = min_block_size << (number_of_classes - 1);
+
+    class cache_t final: public std::pmr::memory_resource
+    {
+    public:
+      static constexpr std::size_t capacity = 32;
+
+      explicit cache_t(slab_resource_t& slab) noexcept
+          : m_slab{ slab }
+      {
+      }
+      cache_t(cache_t const&)            = delete;
+      cache_t(cache_t&&)                 = delete;
+      cache_t& operator=(cache_t const&) = delete;
+      cache_t& operator=(cache_t&&)      = delete;
+      ~cache_t() override;
+
+    private:
+      friend slab_resource_t;
+
+      struct bin_t
+      {
+        std::array<void*, capacity> blocks = {};
+        std::size_t                 size   = 0;
+      };
+
+      void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+      void  do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+      bool  do_is_equal(std::pmr::memory_resource const& other) const noexcept override;
+
+      slab_resource_t&                     m_slab;
+      std::array<bin_t, number_of_classes> m_bins = {};
+    };
+
+    explicit slab_resource_t(std::span<std::byte> buffer, std::pmr::memory_resource* upstream = std::pmr::null_memory_resource()) noexcept
+        : m_buffer{ buffer }
+        , m_upstream{ upstream }
+    {
+    }
+    slab_resource_t(slab_resource_t const&)            = delete;
+    slab_resource_t(slab_resource_t&&)                 = delete;
+    slab_resource_t& operator=(slab_resource_t const&) = delete;
+    slab_resource_t& operator=(slab_resource_t&&)      = delete;
+    ~slab_resource_t() override                        = default;
+
+    std::size_t get_number_of_carved_bytes() const noexcept { return this->m_offset; }
+
+  private:
+    struct free_block_t
+    {
+      free_block_t* next;
+    };
+
+    static std::size_t class_of(std::size_t bytes, std::size_t alignment) noexcept;
+    static std::size_t size_of(std::size_t idx) noexcept { return min_block_size << idx; }
+
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void  do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override;
+    bool  do_is_equal(std::pmr::memory_resource const& other) const noexcept override;
+
+    std::size_t p_pop(std::size_t idx, std::span<void*> blocks);
+    void        p_push(std::size_t idx, std::span<void* const> blocks) noexcept;
+
+    std::span<std::byte>                         m_buffer;
+    std::pmr::memory_resource*                   m_upstream;
+    std::size_t                                  m_offset = 0;
+    std::array<free_block_t*, number_of_classes> m_free   = {};
+    std::atomic_flag                             m_lock   = ATOMIC_FLAG_INIT;
+  };
+}    // namespace wlib::memory
+
+#endif    // WLIB_MEMORY_RESOURCE_HPP_INCLUDED
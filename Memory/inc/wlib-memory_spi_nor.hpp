@@ -0,0 +1,96 @@
+#pragma once
+#ifndef WLIB_MEMORY_SPI_NOR_HPP_INCLUDED
+#define WLIB_MEMORY_SPI_NOR_HPP_INCLUDED
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <wlib-SPI_Interface.hpp>
+#include <wlib-memory.hpp>
+
+namespace wlib::memory
+{
+  enum class nor_read_t : std::uint8_t
+  {
+    normal,    // 03, limited to about 50MHz on most parts
+    fast,      // 0B with one dummy byte, up to the maximum clock of the part
+  };
+
+  struct nor_geometry_t
+  {
+    std::size_t capacity    = 0;
+    std::size_t page_size   = 256;
+    std::size_t sector_size = 4096;
+  };
+
+  // upper bounds of the busy times, a device still busy after them is considered missing or broken
+  struct nor_timeout_t
+  {
+    std::chrono::microseconds page_program = std::chrono::milliseconds{ 5 };
+    std::chrono::microseconds sector_erase = std::chrono::milliseconds{ 500 };
+  };
+
+  // jedec serial nor flash with 3 byte addresses behind a Connection_Provider. writes behave like ram: ranges that
+  // only clear bits are page programmed directly, ranges that need a bit set again are merged with the rest of their
+  // sector, erased and programmed. sector_buffer needs at least sector_size bytes.
+  // write() returns while the device still programs its last page, the next command waits for the busy flag by
+  // polling the status register with chip select held. the number of polls is bounded by the timeout at the configured
+  // baudrate, a device that stays busy, e.g. a missing one reading 0xFF, throws. erased pages are skipped, only that
+  // check and the slicing into pages overlap with the programming of the previous page
+  class spi_nor_memory_t final: public Non_Volatile_Memory_Interface
+  {
+  public:
+    using jedec_id_t = std::array<std::byte, 3>;
+
+    spi_nor_memory_t(SPI::Connection_Provider&       provider,
+                     SPI::SPI_configuration_t const& cfg,
+                     nor_geometry_t const&           geometry,
+                     std::span<std::byte>            sector_buffer,
+                     nor_read_t                      read_mode = nor_read_t::fast,
+                     nor_timeout_t const&            timeout   = {});
+    spi_nor_memory_t(spi_nor_memory_t const&)            = delete;
+    spi_nor_memory_t(spi_nor_memory_t&&)                 = delete;
+    spi_nor_memory_t& operator=(spi_nor_memory_t const&) = delete;
+    spi_nor_memory_t& operator=(spi_nor_memory_t&&)      = delete;
+    ~spi_nor_memory_t() override                         = default;
+
+    std::size_t capacity() const override { return this->m_geometry.capacity; }
+    std::size_t alignment() const override { return 1; }
+    void        write(std::size_t add, std::span<std::byte const> data) override;
+    // waits until the device finished programming
+    void        flush() override;
+    void        read(std::size_t add, std::span<std::byte> data) override;
+
+    jedec_id_t read_jedec_id();
+    void       erase_sector(std::size_t add);
+
+    std::size_t get_number_of_programmed_pages() const noexcept { return this->m_number_of_programmed_pages; }
+    std::size_t get_number_of_erased_sectors() const noexcept { return this->m_number_of_erased_sectors; }
+
+  private:
+    void range_check(std::size_t add, std::size_t len) const;
+
+    void p_write_sector(std::size_t add, std::span<std::byte const> data);
+    void p_program(std::size_t add, std::span<std::byte const> data);
+    void p_read(std::size_t add, std::span<std::byte> data);
+    void p_command(std::uint8_t cmd, std::size_t add);
+    void p_write_enable();
+    void p_wait_ready();
+    void p_set_busy(std::chrono::microseconds timeout) noexcept;
+
+    SPI::Connection_Provider& m_provider;
+    SPI::SPI_configuration_t  m_cfg;
+    nor_geometry_t            m_geometry;
+    std::span<std::byte>      m_sector;
+    nor_read_t                m_read_mode;
+    nor_timeout_t             m_timeout;
+    bool                      m_is_busy                    = false;
+    std::size_t               m_max_polls                  = 0;
+    std::size_t               m_number_of_programmed_pages = 0;
+    std::size_t               m_number_of_erased_sectors   = 0;
+  };
+}    // namespace wlib::memory
+
+#endif
@@ -1,4 +1,10 @@
 #include <wlib-memory.hpp>
 
+//
+#include <stdexcept>
 
-
+namespace wlib::memory
+{
+  void internal::handle_range_exception() { throw std::out_of_range("access exceeds the memory capacity"); }
+  void internal::handle_configuration_exception(char const* what) { throw std::invalid_argument(what); }
+}    // namespace wlib::memory
@@ -0,0 +1,569 @@
+#include <wlib-memory_async.hpp>
+
+//
+#include <cerrno>
+#include <exception>
+#include <stdexcept>
+
+namespace wlib::memory
+{
+  namespace
+  {
+    void handle_pending_request_exception() { throw std::logic_error("io request is still pending"); }
+  }    // namespace
+
+  void Async_Non_Volatile_Memory_Interface::submit_read(io_request_t& req, std::size_t add, std::span<std::byte> data) { this->p_queue(req, op_t::read, add, data.data(), data.size()); }
+
+  void Async_Non_Volatile_Memory_Interface::submit_write(io_request_t& req, std::size_t add, std::span<std::byte const> data)
+  {
+    // the buffer is only read by the device
+    this->p_queue(req, op_t::write, add, const_cast<std::byte*>(data.data()), data.size());
+  }
+
+  void Async_Non_Volatile_Memory_Interface::submit_flush(io_request_t& req) { this->p_queue(req, op_t::flush, 0, nullptr, 0); }
+
+  std::size_t Async_Non_Volatile_Memory_Interface::commit()
+  {
+    std::size_t ret = 0;
+    for (io_request_t* req = this->m_first; req != nullptr;)
+    {
+      io_request_t* const next = req->m_next;
+      req->m_next              = nullptr;
+      req->m_status.store(io_status_t::in_flight, std::memory_order_relaxed);
+      ++this->m_number_of_in_flight;
+      ++ret;
+      this->do_submit(*req, { req->m_op, req->m_add, req->m_data, req->m_size });
+      req = next;
+    }
+    this->m_first = nullptr;
+    this->m_last  = nullptr;
+
+    if (ret != 0)
+      this->do_commit();
+    return ret;
+  }
+
+  std::size_t Async_Non_Volatile_Memory_Interface::poll()
+  {
+    std::size_t const before = this->m_number_of_completed;
+    this->do_reap(false);
+    return this->m_number_of_completed - before;
+  }
+
+  void Async_Non_Volatile_Memory_Interface::wait(io_request_t& req)
+  {
+    if (req.get_status() == io_status_t::queued)
+      this->commit();
+    while (req.is_pending())
+      this->do_reap(true);
+  }
+
+  void Async_Non_Volatile_Memory_Interface::drain()
+  {
+    this->commit();
+    while (this->m_number_of_in_flight != 0)
+      this->do_reap(true);
+  }
+
+  void Async_Non_Volatile_Memory_Interface::complete(io_request_t& req, std::int64_t result)
+  {
+    req.m_result = result;
+    --this->m_number_of_in_flight;
+    ++this->m_number_of_completed;
+    req.m_status.store(result < 0 ? io_status_t::failed : io_status_t::done, std::memory_order_release);
+    if (req.m_on_complete != nullptr)
+      (*req.m_on_complete)(req);
+  }
+
+  void Async_Non_Volatile_Memory_Interface::p_queue(io_request_t& req, op_t op, std::size_t add, std::byte* data, std::size_t size)
+  {
+    if (req.is_pending())
+      handle_pending_request_exception();
+    if (add > this->capacity() || size > this->capacity() - add)
+      internal::handle_range_exception();
+
+    req.m_op     = op;
+    req.m_add    = add;
+    req.m_data   = data;
+    req.m_size   = size;
+    req.m_result = 0;
+    req.m_next   = nullptr;
+    req.m_status.store(io_status_t::queued, std::memory_order_relaxed);
+
+    if (this->m_last == nullptr)
+      this->m_first = &req;
+    else
+      this->m_last->m_next = &req;
+    this->m_last = &req;
+  }
+
+  void async_memory_adapter_t::do_submit(io_request_t& req, request_view_t const& view)
+  {
+    std::int64_t result = static_cast<std::int64_t>(view.size);
+    try
+    {
+      switch (view.op)
+      {
+      case op_t::read:
+        this->m_mem.read(view.add, std::span<std::byte>(view.data, view.size));
+        break;
+      case op_t::write:
+        this->m_mem.write(view.add, std::span<std::byte const>(view.data, view.size));
+        break;
+      case op_t::flush:
+        this->m_mem.flush();
+        break;
+      }
+    }
+    catch (std::exception const&)
+    {
+      result = -EIO;
+    }
+    this->complete(req, result);
+  }
+}    // namespace wlib::memory
+
+#if __has_include(<unistd.h>)
+
+//
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fcntl.h>
+#include <mutex>
+#include <stop_token>
+#include <sys/stat.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace wlib::memory
+{
+  namespace
+  {
+    void handle_system_exception(char const* what) { throw std::system_error(errno, std::generic_category(), what); }
+
+    constexpr std::size_t number_of_pool_workers = 4;
+  }    // namespace
+
+  class async_file_memory_t::engine_t
+  {
+  public:
+    virtual ~engine_t() = default;
+
+    virtual io_backend_t backend() const noexcept                              = 0;
+    virtual void         submit(io_request_t& req, request_view_t const& view) = 0;
+    virtual void         commit()                                              = 0;
+    virtual void         reap(bool blocking, async_file_memory_t& owner)       = 0;
+  };
+
+  // requests wait in the queue until a worker is free, a flush waits for every request started before it and holds
+  // back every request queued after it
+  class async_file_memory_t::pool_engine_t final: public engine_t
+  {
+  public:
+    explicit pool_engine_t(int fd)
+        : m_fd{ fd }
+    {
+      for (std::size_t i = 0; i < number_of_pool_workers; ++i)
+        this->m_workers.emplace_back([this](std::stop_token stop) { this->worker(stop); });
+    }
+    ~pool_engine_t() override
+    {
+      for (std::jthread& worker : this->m_workers)
+        worker.request_stop();
+      this->m_workers.clear();
+    }
+
+    io_backend_t backend() const noexcept override { return io_backend_t::thread_pool; }
+
+    void submit(io_request_t& req, request_view_t const& view) override { this->m_batch.push_back({ &req, view, 0 }); }
+
+    void commit() override
+    {
+      {
+        std::lock_guard lock{ this->m_mutex };
+        this->m_queue.insert(this->m_queue.end(), this->m_batch.begin(), this->m_batch.end());
+      }
+      this->m_batch.clear();
+      this->m_work.notify_all();
+    }
+
+    void reap(bool blocking, async_file_memory_t& owner) override
+    {
+      {
+        std::unique_lock lock{ this->m_mutex };
+        if (blocking)
+          this->m_finished.wait(lock, [this] { return !this->m_done.empty(); });
+        this->m_reaped.swap(this->m_done);
+      }
+      for (job_t const& job : this->m_reaped)
+        owner.complete(*job.req, job.result);
+      this->m_reaped.clear();
+    }
+
+  private:
+    struct job_t
+    {
+      io_request_t*  req;
+      request_view_t view;
+      std::int64_t   result;
+    };
+
+    bool can_start() const noexcept
+    {
+      if (this->m_queue.empty() || this->m_is_flushing)
+        return false;
+      return this->m_queue.front().view.op != op_t::flush || this->m_number_of_active == 0;
+    }
+
+    void worker(std::stop_token stop)
+    {
+      std::unique_lock lock{ this->m_mutex };
+      while (this->m_work.wait(lock, stop, [this] { return this->can_start(); }))
+      {
+        job_t job = this->m_queue.front();
+        this->m_queue.pop_front();
+        this->m_is_flushing = job.view.op == op_t::flush;
+        ++this->m_number_of_active;
+
+        lock.unlock();
+        job.result = this->execute(job.view);
+        lock.lock();
+
+        --this->m_number_of_active;
+        this->m_is_flushing = false;
+        this->m_done.push_back(job);
+        this->m_finished.notify_all();
+        this->m_work.notify_all();
+      }
+    }
+
+    std::int64_t execute(request_view_t const& view) const
+    {
+      if (view.op == op_t::flush)
+        return ::fdatasync(this->m_fd) == 0 ? 0 : -errno;
+
+      std::size_t done = 0;
+      while (done < view.size)
+      {
+        off_t const   offset = static_cast<off_t>(view.add + done);
+        ssize_t const ret    = view.op == op_t::read ? ::pread(this->m_fd, view.data + done, view.size - done, offset)
+                                                     : ::pwrite(this->m_fd, view.data + done, view.size - done, offset);
+        if (ret < 0 && errno == EINTR)
+          continue;
+        if (ret < 0)
+          return -errno;
+        if (ret == 0)
+          break;
+        done += static_cast<std::size_t>(ret);
+      }
+      return static_cast<std::int64_t>(done);
+    }
+
+    int                         m_fd;
+    std::vector<job_t>          m_batch            = {};
+    std::vector<job_t>          m_reaped           = {};
+    std::mutex                  m_mutex            = {};
+    std::condition_variable_any m_work             = {};
+    std::condition_variable     m_finished         = {};
+    std::deque<job_t>           m_queue            = {};
+    std::vector<job_t>          m_done             = {};
+    std::size_t                 m_number_of_active = 0;
+    bool                        m_is_flushing      = false;
+    std::vector<std::jthread>   m_workers          = {};
+  };
+
+#if __has_include(<linux/io_uring.h>)
+
+  // raw io_uring without liburing. requests beyond the ring size wait in a backlog until completions free entries.
+  // like the pool, short reads and writes are resubmitted for the remainder and requests larger than max_sqe_size are
+  // split, so a request completes with its full size unless it fails or reaches the end of the file. a flush is only
+  // submitted into an empty ring and holds back the backlog until it completes, remainders of earlier requests are
+  // therefore always covered by it
+  class async_file_memory_t::uring_engine_t final: public engine_t
+  {
+  public:
+    static std::unique_ptr<engine_t> create(int fd, unsigned entries)
+    {
+      std::unique_ptr<uring_engine_t> ret{ new uring_engine_t(fd) };
+      if (!ret->setup(entries))
+        return nullptr;
+      return ret;
+    }
+    ~uring_engine_t() override
+    {
+      if (this->m_sqes != nullptr)
+        ::munmap(this->m_sqes, this->m_sqes_size);
+      if (this->m_cq_ring != nullptr && this->m_cq_ring != this->m_sq_ring)
+        ::munmap(this->m_cq_ring, this->m_cq_ring_size);
+      if (this->m_sq_ring != nullptr)
+        ::munmap(this->m_sq_ring, this->m_sq_ring_size);
+      if (this->m_ring_fd >= 0)
+        ::close(this->m_ring_fd);
+    }
+
+    io_backend_t backend() const noexcept override { return io_backend_t::io_uring; }
+
+    void submit(io_request_t& req, request_view_t const& view) override { this->m_backlog.push_back({ &req, view, 0 }); }
+
+    void commit() override { this->p_submit(); }
+
+    void reap(bool blocking, async_file_memory_t& owner) override
+    {
+      while (true)
+      {
+        unsigned       head = *this->m_cq_head;
+        unsigned const tail = std::atomic_ref<unsigned>(*this->m_cq_tail).load(std::memory_order_acquire);
+        bool const     any  = head != tail;
+        for (; head != tail; ++head)
+        {
+          io_uring_cqe const& cqe  = this->m_cqes[head & *this->m_cq_mask];
+          unsigned const      slot = static_cast<unsigned>(cqe.user_data);
+          pending_t           job  = this->m_slots[slot];
+          this->m_free_slots.push_back(slot);
+          --this->m_number_in_ring;
+
+          if (job.view.op == op_t::flush)
+          {
+            this->m_is_flushing = false;
+            owner.complete(*job.req, cqe.res);
+            continue;
+          }
+
+          // remainders go in front of the backlog, so a later flush is not submitted before they completed
+          if (cqe.res == -EINTR || cqe.res == -EAGAIN || (cqe.res > 0 && job.done + static_cast<std::size_t>(cqe.res) < job.view.size))
+          {
+            job.done += static_cast<std::size_t>(std::max(cqe.res, 0));
+            this->m_backlog.insert(this->m_backlog.begin(), job);
+            continue;
+          }
+          owner.complete(*job.req, cqe.res < 0 ? cqe.res : static_cast<std::int64_t>(job.done + static_cast<std::size_t>(cqe.res)));
+        }
+        std::atomic_ref<unsigned>(*this->m_cq_head).store(head, std::memory_order_release);
+
+        if (any)
+          this->p_submit();
+        if (any || !blocking || this->m_number_in_ring == 0)
+          return;
+        this->enter(0, 1, IORING_ENTER_GETEVENTS);
+      }
+    }
+
+  private:
+    // keeps single transfers well below the kernel limit of MAX_RW_COUNT and the 32 bit length of an sqe
+    static constexpr std::size_t max_sqe_size = std::size_t{ 1 } << 30;
+
+    struct pending_t
+    {
+      io_request_t*  req;
+      request_view_t view;
+      std::size_t    done;
+    };
+
+    explicit uring_engine_t(int fd) noexcept
+        : m_fd{ fd }
+    {
+    }
+
+    bool setup(unsigned entries)
+    {
+      io_uring_params params = {};
+      this->m_ring_fd        = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+      if (this->m_ring_fd < 0)
+        return false;
+
+      this->m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+      this->m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+      bool const single    = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+      if (single)
+        this->m_sq_ring_size = this->m_cq_ring_size = std::max(this->m_sq_ring_size, this->m_cq_ring_size);
+
+      void* const sq = ::mmap(nullptr, this->m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->m_ring_fd, IORING_OFF_SQ_RING);
+      if (sq == MAP_FAILED)
+        return false;
+      this->m_sq_ring = static_cast<std::byte*>(sq);
+
+      if (single)
+        this->m_cq_ring = this->m_sq_ring;
+      else
+      {
+        void* const cq = ::mmap(nullptr, this->m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->m_ring_fd, IORING_OFF_CQ_RING);
+        if (cq == MAP_FAILED)
+          return false;
+        this->m_cq_ring = static_cast<std::byte*>(cq);
+      }
+
+      this->m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+      void* const sqes  = ::mmap(nullptr, this->m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->m_ring_fd, IORING_OFF_SQES);
+      if (sqes == MAP_FAILED)
+        return false;
+      this->m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+      this->m_sq_tail  = reinterpret_cast<unsigned*>(this->m_sq_ring + params.sq_off.tail);
+      this->m_sq_mask  = reinterpret_cast<unsigned*>(this->m_sq_ring + params.sq_off.ring_mask);
+      this->m_sq_array = reinterpret_cast<unsigned*>(this->m_sq_ring + params.sq_off.array);
+      this->m_cq_head  = reinterpret_cast<unsigned*>(this->m_cq_ring + params.cq_off.head);
+      this->m_cq_tail  = reinterpret_cast<unsigned*>(this->m_cq_ring + params.cq_off.tail);
+      this->m_cq_mask  = reinterpret_cast<unsigned*>(this->m_cq_ring + params.cq_off.ring_mask);
+      this->m_cqes     = reinterpret_cast<io_uring_cqe*>(this->m_cq_ring + params.cq_off.cqes);
+      this->m_entries  = params.sq_entries;
+
+      this->m_slots.resize(this->m_entries);
+      for (unsigned slot = this->m_entries; slot > 0; --slot)
+        this->m_free_slots.push_back(slot - 1);
+
+      return this->supports(IORING_OP_READ) && this->supports(IORING_OP_WRITE) && this->supports(IORING_OP_FSYNC);
+    }
+
+    bool supports(unsigned op) const
+    {
+      constexpr unsigned number_of_ops = 256;
+
+      std::vector<std::byte> buffer(sizeof(io_uring_probe) + number_of_ops * sizeof(io_uring_probe_op));
+      io_uring_probe* const  probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+      if (::syscall(__NR_io_uring_register, this->m_ring_fd, IORING_REGISTER_PROBE, probe, number_of_ops) < 0)
+        return false;
+      return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+    }
+
+    void p_submit()
+    {
+      unsigned       tail    = *this->m_sq_tail;
+      unsigned const first   = tail;
+      std::size_t    written = 0;
+      for (; written < this->m_backlog.size() && this->m_number_in_ring < this->m_entries && !this->m_is_flushing; ++written, ++tail)
+      {
+        pending_t const&      pending = this->m_backlog[written];
+        request_view_t const& view    = pending.view;
+        if (view.op == op_t::flush && this->m_number_in_ring != 0)
+          break;
+
+        unsigned const slot = this->m_free_slots.back();
+        unsigned const idx  = tail & *this->m_sq_mask;
+        io_uring_sqe&  sqe  = this->m_sqes[idx];
+        this->m_free_slots.pop_back();
+        this->m_slots[slot] = pending;
+
+        sqe           = {};
+        sqe.fd        = this->m_fd;
+        sqe.user_data = slot;
+        switch (view.op)
+        {
+        case op_t::read:
+        case op_t::write:
+          sqe.opcode = view.op == op_t::read ? IORING_OP_READ : IORING_OP_WRITE;
+          sqe.off    = view.add + pending.done;
+          sqe.addr   = reinterpret_cast<std::uintptr_t>(view.data + pending.done);
+          sqe.len    = static_cast<std::uint32_t>(std::min(view.size - pending.done, max_sqe_size));
+          break;
+        case op_t::flush:
+          sqe.opcode          = IORING_OP_FSYNC;
+          sqe.fsync_flags     = IORING_FSYNC_DATASYNC;
+          this->m_is_flushing = true;
+          break;
+        }
+        this->m_sq_array[idx] = idx;
+        ++this->m_number_in_ring;
+      }
+      if (written == 0)
+        return;
+
+      this->m_backlog.erase(this->m_backlog.begin(), this->m_backlog.begin() + static_cast<std::ptrdiff_t>(written));
+      std::atomic_ref<unsigned>(*this->m_sq_tail).store(tail, std::memory_order_release);
+      this->enter(tail - first, 0, 0);
+    }
+
+    void enter(unsigned to_submit, unsigned min_complete, unsigned flags)
+    {
+      while (::syscall(__NR_io_uring_enter, this->m_ring_fd, to_submit, min_complete, flags, nullptr, 0) < 0)
+      {
+        if (errno != EINTR)
+          handle_system_exception("io_uring_enter failed");
+      }
+    }
+
+    int                    m_fd;
+    int                    m_ring_fd        = -1;
+    std::byte*             m_sq_ring        = nullptr;
+    std::byte*             m_cq_ring        = nullptr;
+    std::size_t            m_sq_ring_size   = 0;
+    std::size_t            m_cq_ring_size   = 0;
+    io_uring_sqe*          m_sqes           = nullptr;
+    std::size_t            m_sqes_size      = 0;
+    unsigned*              m_sq_tail        = nullptr;
+    unsigned*              m_sq_mask        = nullptr;
+    unsigned*              m_sq_array       = nullptr;
+    unsigned*              m_cq_head        = nullptr;
+    unsigned*              m_cq_tail        = nullptr;
+    unsigned*              m_cq_mask        = nullptr;
+    io_uring_cqe*          m_cqes           = nullptr;
+    unsigned               m_entries        = 0;
+    unsigned               m_number_in_ring = 0;
+    bool                   m_is_flushing    = false;
+    std::vector<pending_t> m_slots          = {};
+    std::vector<unsigned>  m_free_slots     = {};
+    std::vector<pending_t> m_backlog        = {};
+  };
+
+#endif
+
+  async_file_memory_t::async_file_memory_t(char const* path, std::size_t capacity, std::size_t alignment, io_backend_t backend, std::size_t queue_depth)
+      : m_capacity{ capacity }
+      , m_alignment{ alignment }
+  {
+    this->m_fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (this->m_fd < 0)
+      handle_system_exception("unable to open memory file");
+
+    struct stat st = {};
+    if (::fstat(this->m_fd, &st) != 0 || (S_ISREG(st.st_mode) && static_cast<std::size_t>(st.st_size) < capacity && ::ftruncate(this->m_fd, static_cast<off_t>(capacity)) != 0))
+    {
+      ::close(this->m_fd);
+      handle_system_exception("unable to size memory file");
+    }
+
+#if __has_include(<linux/io_uring.h>)
+    if (backend != io_backend_t::thread_pool)
+      this->m_engine = uring_engine_t::create(this->m_fd, static_cast<unsigned>(std::clamp<std::size_t>(queue_depth, 1, 4096)));
+#else
+    static_cast<void>(queue_depth);
+#endif
+    if (this->m_engine == nullptr && backend == io_backend_t::io_uring)
+    {
+      ::close(this->m_fd);
+      errno = ENOSYS;
+      handle_system_exception("io_uring is not available");
+    }
+    if (this->m_engine == nullptr)
+      this->m_engine = std::make_unique<pool_engine_t>(this->m_fd);
+  }
+
+  async_file_memory_t::~async_file_memory_t()
+  {
+    try
+    {
+      this->drain();
+    }
+    catch (...)
+    {
+    }
+    this->m_engine.reset();
+    ::close(this->m_fd);
+  }
+
+  io_backend_t async_file_memory_t::get_backend() const noexcept { return this->m_engine->backend(); }
+
+  void async_file_memory_t::do_submit(io_request_t& req, request_view_t const& view) { this->m_engine->submit(req, view); }
+  void async_file_memory_t::do_commit() { this->m_engine->commit(); }
+  void async_file_memory_t::do_reap(bool blocking) { this->m_engine->reap(blocking, *this); }
+}    // namespace wlib::memory
+
+#endif
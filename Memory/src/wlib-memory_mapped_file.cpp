@@ -0,0 +1,136 @@
+#include <wlib-memory_mapped_file.hpp>
+
+#if __has_include(<sys/mman.h>)
+
+//
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace wlib::memory
+{
+  namespace
+  {
+    constexpr std::size_t bits_per_word = 64;
+
+    // takes the error code explicitly, the cleanup between the failing call and the throw may change errno
+    void handle_system_exception(int error, char const* what) { throw std::system_error(error, std::generic_category(), what); }
+  }    // namespace
+
+  mapped_file_memory_t::mapped_file_memory_t(char const* path, std::size_t capacity, std::size_t alignment)
+      : m_capacity{ capacity }
+      , m_alignment{ alignment }
+      , m_page_size{ static_cast<std::size_t>(::sysconf(_SC_PAGESIZE)) }
+  {
+    this->m_fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (this->m_fd < 0)
+      handle_system_exception(errno, "unable to open memory file");
+
+    struct stat st = {};
+    if (::fstat(this->m_fd, &st) != 0 || (static_cast<std::size_t>(st.st_size) < capacity && ::ftruncate(this->m_fd, static_cast<off_t>(capacity)) != 0))
+    {
+      int const error = errno;
+      ::close(this->m_fd);
+      handle_system_exception(error, "unable to size memory file");
+    }
+
+    void* const mem = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, this->m_fd, 0);
+    if (mem == MAP_FAILED)
+    {
+      int const error = errno;
+      ::close(this->m_fd);
+      handle_system_exception(error, "unable to map memory file");
+    }
+
+    this->m_mem = static_cast<std::byte*>(mem);
+    std::size_t const pages = (capacity + this->m_page_size - 1) / this->m_page_size;
+    this->m_dirty.resize((pages + bits_per_word - 1) / bits_per_word);
+  }
+
+  mapped_file_memory_t::~mapped_file_memory_t()
+  {
+    try
+    {
+      this->flush();
+    }
+    catch (...)
+    {
+    }
+    ::munmap(this->m_mem, this->m_capacity);
+    ::close(this->m_fd);
+  }
+
+  void mapped_file_memory_t::write(std::size_t add, std::span<std::byte const> data)
+  {
+    this->range_check(add, data.size());
+    if (data.empty())
+      return;
+
+    std::memcpy(this->m_mem + add, data.data(), data.size());
+
+    std::size_t const first = add / this->m_page_size;
+    std::size_t const last  = (add + data.size() - 1) / this->m_page_size;
+    for (std::size_t page = first; page <= last; ++page)
+      this->m_dirty[page / bits_per_word] |= std::uint64_t(1) << (page % bits_per_word);
+  }
+
+  void mapped_file_memory_t::flush()
+  {
+    std::size_t const pages = (this->m_capacity + this->m_page_size - 1) / this->m_page_size;
+
+    std::size_t page = 0;
+    while (page < pages)
+    {
+      std::uint64_t const word = this->m_dirty[page / bits_per_word] >> (page % bits_per_word);
+      if (word == 0)
+      {
+        page = (page / bits_per_word + 1) * bits_per_word;
+        continue;
+      }
+      page += static_cast<std::size_t>(std::countr_zero(word));
+
+      std::size_t end = page;
+      while (end < pages && ((this->m_dirty[end / bits_per_word] >> (end % bits_per_word)) & 1) != 0)
+        ++end;
+
+      std::size_t const off = page * this->m_page_size;
+      std::size_t const len = std::min(end * this->m_page_size, this->m_capacity) - off;
+      if (::msync(this->m_mem + off, len, MS_SYNC) != 0)
+        handle_system_exception(errno, "unable to sync memory file");
+
+      // the run stays dirty when the sync fails, so the next flush retries it
+      for (std::size_t i = page; i < end; ++i)
+        this->m_dirty[i / bits_per_word] &= ~(std::uint64_t(1) << (i % bits_per_word));
+
+      page = end;
+    }
+  }
+
+  void mapped_file_memory_t::read(std::size_t add, std::span<std::byte> data)
+  {
+    this->range_check(add, data.size());
+    std::memcpy(data.data(), this->m_mem + add, data.size());
+  }
+
+  std::size_t mapped_file_memory_t::get_number_of_dirty_pages() const noexcept
+  {
+    std::size_t ret = 0;
+    for (std::uint64_t const word : this->m_dirty)
+      ret += static_cast<std::size_t>(std::popcount(word));
+    return ret;
+  }
+
+  void mapped_file_memory_t::range_check(std::size_t add, std::size_t len) const
+  {
+    if (add > this->m_capacity || len > this->m_capacity - add)
+      internal::handle_range_exception();
+  }
+}    // namespace wlib::memory
+
+#endif
@@ -0,0 +1,197 @@
+#include <wlib-memory_resource.hpp>
+
+//
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <new>
+
+namespace wlib::memory
+{
+  namespace
+  {
+    class spin_guard_t
+    {
+    public:
+      explicit spin_guard_t(std::atomic_flag& flag) noexcept
+          : m_flag{ flag }
+      {
+        while (this->m_flag.test_and_set(std::memory_order_acquire))
+          this->m_flag.wait(true, std::memory_order_relaxed);
+      }
+      spin_guard_t(spin_guard_t const&)            = delete;
+      spin_guard_t(spin_guard_t&&)                 = delete;
+      spin_guard_t& operator=(spin_guard_t const&) = delete;
+      spin_guard_t& operator=(spin_guard_t&&)      = delete;
+      ~spin_guard_t()
+      {
+        this->m_flag.clear(std::memory_order_release);
+        this->m_flag.notify_one();
+      }
+
+    private:
+      std::atomic_flag& m_flag;
+    };
+
+    std::size_t align_up(std::byte const* base, std::size_t offset, std::size_t alignment) noexcept
+    {
+      std::uintptr_t const add = reinterpret_cast<std::uintptr_t>(base) + offset;
+      return offset + ((alignment - add % alignment) % alignment);
+    }
+
+    bool is_inside(std::span<std::byte const> buffer, void const* p) noexcept
+    {
+      std::less<> const less;
+      return !less(p, buffer.data()) && less(p, buffer.data() + buffer.size());
+    }
+  }    // namespace
+
+  arena_resource_t::~arena_resource_t() { this->release(); }
+
+  void arena_resource_t::release() noexcept
+  {
+    chunk_t* chunk = this->m_chunks.exchange(nullptr, std::memory_order_acquire);
+    while (chunk != nullptr)
+    {
+      chunk_t* const next = chunk->next;
+      this->m_upstream->deallocate(chunk, chunk->size, chunk->alignment);
+      chunk = next;
+    }
+    this->m_offset.store(0, std::memory_order_relaxed);
+  }
+
+  void* arena_resource_t::do_allocate(std::size_t bytes, std::size_t alignment)
+  {
+    std::size_t offset = this->m_offset.load(std::memory_order_relaxed);
+    while (true)
+    {
+      std::size_t const beg = align_up(this->m_buffer.data(), offset, alignment);
+      if (beg > this->m_buffer.size() || bytes > this->m_buffer.size() - beg)
+        return this->p_allocate_upstream(bytes, alignment);
+
+      if (this->m_offset.compare_exchange_weak(offset, beg + bytes, std::memory_order_relaxed))
+        return this->m_buffer.data() + beg;
+    }
+  }
+
+  void* arena_resource_t::p_allocate_upstream(std::size_t bytes, std::size_t alignment)
+  {
+    // the header sits in front of the block, padded to keep the block aligned
+    std::size_t const align  = std::max(alignment, alignof(chunk_t));
+    std::size_t const header = (sizeof(chunk_t) + align - 1) / align * align;
+    if (bytes > SIZE_MAX - header)
+      throw std::bad_alloc();
+
+    std::byte* const base  = static_cast<std::byte*>(this->m_upstream->allocate(header + bytes, align));
+    chunk_t* const   chunk = ::new (base) chunk_t{ this->m_chunks.load(std::memory_order_relaxed), header + bytes, align };
+    while (!this->m_chunks.compare_exchange_weak(chunk->next, chunk, std::memory_order_release, std::memory_order_relaxed))
+      ;
+    return base + header;
+  }
+
+  slab_resource_t::cache_t::~cache_t()
+  {
+    for (std::size_t idx = 0; idx < number_of_classes; ++idx)
+      this->m_slab.p_push(idx, std::span<void* const>(this->m_bins[idx].blocks.data(), this->m_bins[idx].size));
+  }
+
+  void* slab_resource_t::cache_t::do_allocate(std::size_t bytes, std::size_t alignment)
+  {
+    std::size_t const idx = class_of(bytes, alignment);
+    if (idx == number_of_classes)
+      return this->m_slab.allocate(bytes, alignment);
+
+    bin_t& bin = this->m_bins[idx];
+    if (bin.size == 0)
+      bin.size = this->m_slab.p_pop(idx, std::span<void*>(bin.blocks.data(), capacity / 2));
+    if (bin.size == 0)
+      return this->m_slab.allocate(bytes, alignment);
+    return bin.blocks[--bin.size];
+  }
+
+  void slab_resource_t::cache_t::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+  {
+    std::size_t const idx = class_of(bytes, alignment);
+    if (idx == number_of_classes || !is_inside(this->m_slab.m_buffer, p))
+      return this->m_slab.deallocate(p, bytes, alignment);
+
+    bin_t& bin = this->m_bins[idx];
+    if (bin.size == capacity)
+    {
+      bin.size -= capacity / 2;
+      this->m_slab.p_push(idx, std::span<void* const>(bin.blocks.data() + bin.size, capacity / 2));
+    }
+    bin.blocks[bin.size++] = p;
+  }
+
+  bool slab_resource_t::cache_t::do_is_equal(std::pmr::memory_resource const& other) const noexcept { return other.is_equal(this->m_slab); }
+
+  std::size_t slab_resource_t::class_of(std::size_t bytes, std::size_t alignment) noexcept
+  {
+    std::size_t const size = std::max({ bytes, alignment, min_block_size });
+    if (size > max_block_size)
+      return number_of_classes;
+    return static_cast<std::size_t>(std::bit_width(size - 1)) - static_cast<std::size_t>(std::countr_zero(min_block_size));
+  }
+
+  void* slab_resource_t::do_allocate(std::size_t bytes, std::size_t alignment)
+  {
+    std::size_t const idx = class_of(bytes, alignment);
+    void*             ret = nullptr;
+    if (idx == number_of_classes || this->p_pop(idx, std::span<void*>(&ret, 1)) == 0)
+      return this->m_upstream->allocate(bytes, alignment);
+    return ret;
+  }
+
+  void slab_resource_t::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+  {
+    if (!is_inside(this->m_buffer, p))
+      return this->m_upstream->deallocate(p, bytes, alignment);
+
+    void* const blocks[] = { p };
+    this->p_push(class_of(bytes, alignment), blocks);
+  }
+
+  bool slab_resource_t::do_is_equal(std::pmr::memory_resource const& other) const noexcept
+  {
+    if (this == &other)
+      return true;
+    cache_t const* const cache = dynamic_cast<cache_t const*>(&other);
+    return cache != nullptr && &cache->m_slab == this;
+  }
+
+  std::size_t slab_resource_t::p_pop(std::size_t idx, std::span<void*> blocks)
+  {
+    spin_guard_t guard{ this->m_lock };
+
+    std::size_t ret = 0;
+    for (; ret < blocks.size() && this->m_free[idx] != nullptr; ++ret)
+    {
+      blocks[ret]       = this->m_free[idx];
+      this->m_free[idx] = this->m_free[idx]->next;
+    }
+
+    // blocks are aligned to their size, which covers every alignment mapped to the class
+    std::size_t const size = size_of(idx);
+    for (; ret < blocks.size(); ++ret)
+    {
+      std::size_t const beg = align_up(this->m_buffer.data(), this->m_offset, size);
+      if (beg > this->m_buffer.size() || size > this->m_buffer.size() - beg)
+        break;
+
+      blocks[ret]    = this->m_buffer.data() + beg;
+      this->m_offset = beg + size;
+    }
+    return ret;
+  }
+
+  void slab_resource_t::p_push(std::size_t idx, std::span<void* const> blocks) noexcept
+  {
+    if (blocks.empty())
+      return;
+
+    spin_guard_t guard{ this->m_lock };
+    for (void* const block : blocks)
+      this->m_free[idx] = ::new (block) free_block_t{ this->m_free[idx] };
+  }
+}    // namespace wlib::memory
@@ -0,0 +1,246 @@
+#include <wlib-memory_spi_nor.hpp>
+
+//
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace wlib::memory
+{
+  namespace
+  {
+    void handle_timeout_exception() { throw std::runtime_error("spi nor flash stays busy, the device is missing or broken"); }
+
+    enum nor_cmd_t : std::uint8_t
+    {
+      cmd_page_program = 0x02,
+      cmd_read         = 0x03,
+      cmd_read_status  = 0x05,
+      cmd_write_enable = 0x06,
+      cmd_fast_read    = 0x0B,
+      cmd_sector_erase = 0x20,
+      cmd_read_id      = 0x9F,
+    };
+
+    constexpr std::byte   status_busy     = std::byte{ 0x01 };
+    constexpr std::size_t max_capacity    = std::size_t{ 1 } << 24;
+    constexpr std::size_t address_cmd_len = 4;
+
+    using header_t = std::array<std::byte, address_cmd_len + 1>;
+
+    constexpr header_t make_header(std::uint8_t cmd, std::size_t add) noexcept
+    {
+      return { std::byte{ cmd }, static_cast<std::byte>(add >> 16), static_cast<std::byte>(add >> 8), static_cast<std::byte>(add), std::byte{ 0x00 } };
+    }
+
+    bool is_erased(std::span<std::byte const> data) noexcept
+    {
+      return std::all_of(data.begin(), data.end(), [](std::byte b) { return b == std::byte{ 0xFF }; });
+    }
+  }    // namespace
+
+  spi_nor_memory_t::spi_nor_memory_t(SPI::Connection_Provider&       provider,
+                                     SPI::SPI_configuration_t const& cfg,
+                                     nor_geometry_t const&           geometry,
+                                     std::span<std::byte>            sector_buffer,
+                                     nor_read_t                      read_mode,
+                                     nor_timeout_t const&            timeout)
+      : m_provider{ provider }
+      , m_cfg{ cfg }
+      , m_geometry{ geometry }
+      , m_sector{ sector_buffer.first(std::min(sector_buffer.size(), geometry.sector_size)) }
+      , m_read_mode{ read_mode }
+      , m_timeout{ timeout }
+  {
+    if (geometry.page_size == 0 || geometry.sector_size % geometry.page_size != 0 || geometry.capacity % geometry.sector_size != 0)
+      internal::handle_configuration_exception("nor sector size is not a multiple of the page size or capacity not a multiple of the sector size");
+    if (geometry.capacity > max_capacity)
+      internal::handle_configuration_exception("nor capacity exceeds 3 byte addressing");
+    if (sector_buffer.size() < geometry.sector_size)
+      internal::handle_configuration_exception("sector buffer is smaller than the nor sector size");
+
+    // the device may still erase a sector for a previous user
+    this->p_set_busy(this->m_timeout.sector_erase);
+  }
+
+  void spi_nor_memory_t::write(std::size_t add, std::span<std::byte const> data)
+  {
+    this->range_check(add, data.size());
+    while (!data.empty())
+    {
+      std::size_t const len = std::min(data.size(), this->m_geometry.sector_size - add % this->m_geometry.sector_size);
+      this->p_write_sector(add, data.first(len));
+
+      add += len;
+      data = data.subspan(len);
+    }
+  }
+
+  void spi_nor_memory_t::flush() { this->p_wait_ready(); }
+
+  void spi_nor_memory_t::read(std::size_t add, std::span<std::byte> data)
+  {
+    this->range_check(add, data.size());
+    this->p_read(add, data);
+  }
+
+  spi_nor_memory_t::jedec_id_t spi_nor_memory_t::read_jedec_id()
+  {
+    this->p_wait_ready();
+
+    jedec_id_t              ret  = {};
+    std::byte const         cmd  = std::byte{ cmd_read_id };
+    SPI::tx_segment_t const tx[] = { std::span<std::byte const>{ &cmd, 1 } };
+    SPI::rx_segment_t const rx[] = { SPI::rx_segment_t{ 1 }, std::span<std::byte>{ ret } };
+
+    auto con = this->m_provider.request(this->m_cfg);
+    con.transcieve(tx, rx);
+    return ret;
+  }
+
+  void spi_nor_memory_t::erase_sector(std::size_t add)
+  {
+    this->range_check(add, 1);
+    this->p_command(cmd_sector_erase, add - add % this->m_geometry.sector_size);
+    ++this->m_number_of_erased_sectors;
+  }
+
+  void spi_nor_memory_t::range_check(std::size_t add, std::size_t len) const
+  {
+    if (add > this->m_geometry.capacity || len > this->m_geometry.capacity - add)
+      internal::handle_range_exception();
+  }
+
+  void spi_nor_memory_t::p_write_sector(std::size_t add, std::span<std::byte const> data)
+  {
+    std::size_t const          sector_add = add - add % this->m_geometry.sector_size;
+    std::size_t const          offset     = add - sector_add;
+    std::span<std::byte> const current    = this->m_sector.subspan(offset, data.size());
+    this->p_read(add, current);
+
+    // programming can only clear bits, setting one needs the whole sector erased
+    bool        needs_erase = false;
+    std::size_t first       = data.size();
+    std::size_t last        = 0;
+    for (std::size_t i = 0; i < data.size(); ++i)
+    {
+      if (current[i] == data[i])
+        continue;
+
+      needs_erase = needs_erase || (current[i] & data[i]) != data[i];
+      first       = std::min(first, i);
+      last        = i + 1;
+    }
+
+    if (first == data.size())
+      return;
+
+    if (!needs_erase)
+      return this->p_program(add + first, data.subspan(first, last - first));
+
+    this->p_read(sector_add, this->m_sector.first(offset));
+    this->p_read(add + data.size(), this->m_sector.subspan(offset + data.size()));
+    std::memcpy(current.data(), data.data(), data.size());
+
+    this->erase_sector(sector_add);
+    this->p_program(sector_add, this->m_sector);
+  }
+
+  void spi_nor_memory_t::p_program(std::size_t add, std::span<std::byte const> data)
+  {
+    while (!data.empty())
+    {
+      std::size_t const                len   = std::min(data.size(), this->m_geometry.page_size - add % this->m_geometry.page_size);
+      std::span<std::byte const> const chunk = data.first(len);
+
+      // prepared while the device still programs the previous page, only the command below waits for it
+      if (!is_erased(chunk))
+      {
+        this->p_write_enable();
+
+        header_t const          header = make_header(cmd_page_program, add);
+        SPI::tx_segment_t const tx[]   = { std::span<std::byte const>{ header }.first(address_cmd_len), chunk };
+
+        auto con = this->m_provider.request(this->m_cfg);
+        con.transcieve(tx, {});
+        this->p_set_busy(this->m_timeout.page_program);
+        ++this->m_number_of_programmed_pages;
+      }
+
+      add += len;
+      data = data.subspan(len);
+    }
+  }
+
+  void spi_nor_memory_t::p_read(std::size_t add, std::span<std::byte> data)
+  {
+    if (data.empty())
+      return;
+
+    this->p_wait_ready();
+
+    // reads stream across the whole array, the chunks only keep single transfers within common driver limits
+    bool const        is_fast    = this->m_read_mode == nor_read_t::fast;
+    std::size_t const header_len = is_fast ? address_cmd_len + 1 : address_cmd_len;
+    while (!data.empty())
+    {
+      std::size_t const       len    = std::min(data.size(), this->m_geometry.sector_size);
+      header_t const          header = make_header(is_fast ? cmd_fast_read : cmd_read, add);
+      SPI::tx_segment_t const tx[]   = { std::span<std::byte const>{ header }.first(header_len) };
+      SPI::rx_segment_t const rx[]   = { SPI::rx_segment_t{ header_len }, data.first(len) };
+
+      auto con = this->m_provider.request(this->m_cfg);
+      con.transcieve(tx, rx);
+
+      add += len;
+      data = data.subspan(len);
+    }
+  }
+
+  void spi_nor_memory_t::p_command(std::uint8_t cmd, std::size_t add)
+  {
+    this->p_write_enable();
+
+    header_t const header = make_header(cmd, add);
+    auto           con    = this->m_provider.request(this->m_cfg);
+    con.transcieve(header.data(), nullptr, address_cmd_len);
+    this->p_set_busy(this->m_timeout.sector_erase);
+  }
+
+  void spi_nor_memory_t::p_write_enable()
+  {
+    this->p_wait_ready();
+
+    std::byte const cmd = std::byte{ cmd_write_enable };
+    auto            con = this->m_provider.request(this->m_cfg);
+    con.transcieve(&cmd, nullptr, 1);
+  }
+
+  void spi_nor_memory_t::p_wait_ready()
+  {
+    if (!this->m_is_busy)
+      return;
+
+    // the status register is clocked out repeatedly as long as chip select stays asserted
+    std::byte const cmd    = std::byte{ cmd_read_status };
+    std::byte       status = status_busy;
+    auto            con    = this->m_provider.request(this->m_cfg);
+    con.transcieve(&cmd, nullptr, 1);
+    for (std::size_t polls = 0; (status & status_busy) != std::byte{ 0 }; ++polls)
+    {
+      if (polls == this->m_max_polls)
+        handle_timeout_exception();
+      con.transcieve(nullptr, &status, 1);
+    }
+
+    this->m_is_busy = false;
+  }
+
+  void spi_nor_memory_t::p_set_busy(std::chrono::microseconds timeout) noexcept
+  {
+    // every poll clocks at least one byte, so the bound is reached no earlier than the timeout
+    std::uint64_t const baudrate = std::max<std::uint64_t>(this->m_cfg.get_baudrate(), 1);
+    this->m_max_polls            = static_cast<std::size_t>(static_cast<std::uint64_t>(timeout.count()) * baudrate / 8'000'000 + 1);
+    this->m_is_busy              = true;
+  }
+}    // namespace wlib::memory
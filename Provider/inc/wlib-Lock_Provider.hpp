@@ -0,0 +1,257 @@
+#pragma once
+#ifndef WLIB_LOCK_PROVIDER_HPP_INCLUDED
+#define WLIB_LOCK_PROVIDER_HPP_INCLUDED
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <wlib-Provider_Interface.hpp>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace wlib
+{
+  template <typename T> concept lockable = requires(T& lock) {
+    lock.lock();
+    { lock.try_lock() } -> std::convertible_to<bool>;
+    lock.unlock();
+  };
+
+  template <typename T> concept shared_lockable = lockable<T> && requires(T& lock) {
+    lock.lock_shared();
+    { lock.try_lock_shared() } -> std::convertible_to<bool>;
+    lock.unlock_shared();
+  };
+
+  namespace internal
+  {
+    inline void cpu_relax() noexcept
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+      _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+      __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+      __asm__ __volatile__("yield");
+#endif
+    }
+  }    // namespace internal
+
+  // 0 unlocked, 1 locked, 2 locked with possible waiters. unlock() only wakes a thread if somebody went to sleep
+  class futex_mutex_t
+  {
+  public:
+    futex_mutex_t()                                = default;
+    futex_mutex_t(futex_mutex_t const&)            = delete;
+    futex_mutex_t(futex_mutex_t&&)                 = delete;
+    futex_mutex_t& operator=(futex_mutex_t const&) = delete;
+    futex_mutex_t& operator=(futex_mutex_t&&)      = delete;
+
+    void lock() noexcept
+    {
+      if (this->try_lock())
+        return;
+      this->p_lock_contended();
+    }
+
+    bool try_lock() noexcept
+    {
+      std::uint32_t expected = unlocked;
+      return this->m_state.compare_exchange_strong(expected, locked, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() noexcept
+    {
+      if (this->m_state.exchange(unlocked, std::memory_order_release) == contended)
+        this->m_state.notify_one();
+    }
+
+  protected:
+    bool is_locked() const noexcept { return this->m_state.load(std::memory_order_relaxed) != unlocked; }
+
+    void p_lock_contended() noexcept
+    {
+      while (this->m_state.exchange(contended, std::memory_order_acquire) != unlocked)
+        this->m_state.wait(contended, std::memory_order_relaxed);
+    }
+
+  private:
+    static constexpr std::uint32_t unlocked  = 0;
+    static constexpr std::uint32_t locked    = 1;
+    static constexpr std::uint32_t contended = 2;
+
+    std::atomic<std::uint32_t> m_state = unlocked;
+  };
+
+  // spins for short critical sections before it falls back to sleeping like futex_mutex_t
+  template <std::size_t SpinCount = 128> class adaptive_mutex_t final: public futex_mutex_t
+  {
+  public:
+    void lock() noexcept
+    {
+      for (std::size_t i = 0; i < SpinCount; ++i)
+      {
+        if (!this->is_locked() && this->try_lock())
+          return;
+        internal::cpu_relax();
+      }
+      this->p_lock_contended();
+    }
+  };
+
+  // any number of readers or one writer. a waiting writer blocks new readers so writers can not starve
+  class shared_mutex_t
+  {
+  public:
+    shared_mutex_t()                                 = default;
+    shared_mutex_t(shared_mutex_t const&)            = delete;
+    shared_mutex_t(shared_mutex_t&&)                 = delete;
+    shared_mutex_t& operator=(shared_mutex_t const&) = delete;
+    shared_mutex_t& operator=(shared_mutex_t&&)      = delete;
+
+    void lock() noexcept
+    {
+      std::uint32_t state = this->m_state.load(std::memory_order_relaxed);
+      while (true)
+      {
+        if ((state & ~pending) == 0)
+        {
+          if (this->m_state.compare_exchange_weak(state, writer, std::memory_order_acquire, std::memory_order_relaxed))
+            return;
+          continue;
+        }
+
+        if ((state & pending) == 0)
+        {
+          if (!this->m_state.compare_exchange_weak(state, state | pending, std::memory_order_relaxed))
+            continue;
+          state |= pending;
+        }
+
+        this->m_state.wait(state, std::memory_order_relaxed);
+        state = this->m_state.load(std::memory_order_relaxed);
+      }
+    }
+
+    bool try_lock() noexcept
+    {
+      std::uint32_t state = this->m_state.load(std::memory_order_relaxed);
+      while ((state & ~pending) == 0)
+      {
+        if (this->m_state.compare_exchange_weak(state, writer, std::memory_order_acquire, std::memory_order_relaxed))
+          return true;
+      }
+      return false;
+    }
+
+    void unlock() noexcept
+    {
+      this->m_state.store(0, std::memory_order_release);
+      this->m_state.notify_all();
+    }
+
+    void lock_shared() noexcept
+    {
+      std::uint32_t state = this->m_state.load(std::memory_order_relaxed);
+      while (true)
+      {
+        if ((state & (writer | pending)) != 0)
+        {
+          this->m_state.wait(state, std::memory_order_relaxed);
+          state = this->m_state.load(std::memory_order_relaxed);
+          continue;
+        }
+
+        if (this->m_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed))
+          return;
+      }
+    }
+
+    bool try_lock_shared() noexcept
+    {
+      std::uint32_t state = this->m_state.load(std::memory_order_relaxed);
+      while ((state & (writer | pending)) == 0)
+      {
+        if (this->m_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed))
+          return true;
+      }
+      return false;
+    }
+
+    void unlock_shared() noexcept
+    {
+      // only a pending writer sleeps while readers are active
+      if (this->m_state.fetch_sub(1, std::memory_order_release) - 1 == pending)
+        this->m_state.notify_all();
+    }
+
+  private:
+    static constexpr std::uint32_t writer  = 0x8000'0000;
+    static constexpr std::uint32_t pending = 0x4000'0000;
+
+    std::atomic<std::uint32_t> m_state = 0;
+  };
+
+  template <lockable Tlock = futex_mutex_t> class Locked_Memory_Provider final: public Shared_Memory_Provider_Interface
+  {
+  public:
+    explicit Locked_Memory_Provider(std::span<std::byte> memory)
+        : Shared_Memory_Provider_Interface(memory)
+    {
+    }
+
+  private:
+    void lock() override { this->m_lock.lock(); }
+    bool try_lock() override { return this->m_lock.try_lock(); }
+    void unlock() override { this->m_lock.unlock(); }
+
+    Tlock m_lock;
+  };
+
+  // with a shared_lockable Tlock request_shared() lets readers access the resource concurrently
+  template <typename T, lockable Tlock = futex_mutex_t> class Locked_Resource_Provider final: public Shared_Resource_Provider_Interface<T>
+  {
+  public:
+    explicit Locked_Resource_Provider(T& resource)
+        : Shared_Resource_Provider_Interface<T>(resource)
+    {
+    }
+
+  private:
+    void lock() override { this->m_lock.lock(); }
+    bool try_lock() override { return this->m_lock.try_lock(); }
+    void unlock() override { this->m_lock.unlock(); }
+
+    void lock_shared() override
+    {
+      if constexpr (shared_lockable<Tlock>)
+        this->m_lock.lock_shared();
+      else
+        this->m_lock.lock();
+    }
+    bool try_lock_shared() override
+    {
+      if constexpr (shared_lockable<Tlock>)
+        return this->m_lock.try_lock_shared();
+      else
+        return this->m_lock.try_lock();
+    }
+    void unlock_shared() override
+    {
+      if constexpr (shared_lockable<Tlock>)
+        this->m_lock.unlock_shared();
+      else
+        this->m_lock.unlock();
+    }
+
+    Tlock m_lock;
+  };
+
+  template <typename T> using Reader_Writer_Provider = Locked_Resource_Provider<T, shared_mutex_t>;
+}    // namespace wlib
+
+#endif
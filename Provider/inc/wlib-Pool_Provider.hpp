@@ -0,0 +1,96 @@
+#pragma once
+#ifndef WLIB_POOL_PROVIDER_HPP_INCLUDED
+#define WLIB_POOL_PROVIDER_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <wlib-Provider_Interface.hpp>
+
+namespace wlib
+{
+  // splits memory into NumberOfBuffers equally sized buffers, request() hands out any free buffer and only blocks when
+  // all of them are in use. the free list is a tagged lock free stack
+  template <std::size_t NumberOfBuffers>
+    requires(NumberOfBuffers > 0 && NumberOfBuffers < UINT32_MAX)
+  class Pool_Memory_Provider final: public Shared_Memory_Provider_Interface
+  {
+  public:
+    explicit Pool_Memory_Provider(std::span<std::byte> memory)
+        : Shared_Memory_Provider_Interface({})
+        , m_memory{ memory }
+        , m_buffer_size{ memory.size() / NumberOfBuffers }
+    {
+      if (this->m_buffer_size == 0)
+        internal::handle_configuration_exception("pool memory is smaller than the number of buffers");
+      for (std::size_t i = 0; i < NumberOfBuffers; ++i)
+        this->m_next[i].store(static_cast<std::uint32_t>(i + 1 < NumberOfBuffers ? i + 2 : 0), std::memory_order_relaxed);
+      this->m_head.store(1, std::memory_order_release);
+    }
+
+    std::size_t get_buffer_size() const noexcept { return this->m_buffer_size; }
+    std::size_t get_number_of_free_buffers() const noexcept { return this->m_number_of_free.load(std::memory_order_relaxed); }
+
+  private:
+    static constexpr std::uint64_t idx_msk = 0xFFFF'FFFF;
+
+    // head holds a tag in the upper half against aba and the index + 1 of the first free buffer, 0 is the empty list
+    static constexpr std::uint64_t make_head(std::uint64_t old, std::uint32_t idx) noexcept { return ((old >> 32) + 1) << 32 | idx; }
+
+    resource_t acquire() override { return *this->p_pop(true); }
+
+    std::optional<resource_t> try_acquire() override { return this->p_pop(false); }
+
+    std::optional<resource_t> p_pop(bool wait)
+    {
+      std::uint64_t head = this->m_head.load(std::memory_order_acquire);
+      while (true)
+      {
+        std::uint32_t const idx = static_cast<std::uint32_t>(head & idx_msk);
+        if (idx == 0)
+        {
+          if (!wait)
+            return std::nullopt;
+          this->m_head.wait(head, std::memory_order_acquire);
+          head = this->m_head.load(std::memory_order_acquire);
+          continue;
+        }
+
+        std::uint32_t const next = this->m_next[idx - 1].load(std::memory_order_relaxed);
+        if (this->m_head.compare_exchange_weak(head, make_head(head, next), std::memory_order_acquire, std::memory_order_acquire))
+        {
+          this->m_number_of_free.fetch_sub(1, std::memory_order_relaxed);
+          return this->m_memory.subspan((idx - 1) * this->m_buffer_size, this->m_buffer_size);
+        }
+      }
+    }
+
+    void release(resource_t resource) override
+    {
+      std::uint32_t const idx  = static_cast<std::uint32_t>((resource.data() - this->m_memory.data()) / this->m_buffer_size);
+      std::uint64_t       head = this->m_head.load(std::memory_order_relaxed);
+      do
+      {
+        this->m_next[idx].store(static_cast<std::uint32_t>(head & idx_msk), std::memory_order_relaxed);
+      } while (!this->m_head.compare_exchange_weak(head, make_head(head, idx + 1), std::memory_order_release, std::memory_order_relaxed));
+
+      this->m_number_of_free.fetch_add(1, std::memory_order_relaxed);
+      this->m_head.notify_one();
+    }
+
+    // acquire(), try_acquire() and release() replace the single span locking, only a directly constructed
+    // resource_token_t locks, it holds no pool buffer
+    void lock() override {}
+    void unlock() override {}
+
+    std::span<std::byte>       m_memory;
+    std::size_t                m_buffer_size;
+    std::atomic<std::uint64_t> m_head                  = 0;
+    std::atomic<std::uint32_t> m_next[NumberOfBuffers] = {};
+    std::atomic<std::size_t>   m_number_of_free        = NumberOfBuffers;
+  };
+}    // namespace wlib
+
+#endif
@@ -2,12 +2,38 @@
 #ifndef WLIB_PROVIDER_INTERFACE_HPP_INCLUDED
 #define WLIB_PROVIDER_INTERFACE_HPP_INCLUDED
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <span>
+#include <thread>
+#include <utility>
 
 namespace wlib
 {
+  namespace internal
+  {
+    [[noreturn]] void handle_configuration_exception(char const* what);
+
+    // polls fn until it succeeds or the timeout is over, spins first and yields afterwards
+    template <typename Tfn, typename Rep, typename Period> auto try_for(Tfn&& fn, std::chrono::duration<Rep, Period> const& timeout)
+    {
+      using clock_t = std::chrono::steady_clock;
+
+      auto const deadline = clock_t::now() + std::chrono::ceil<clock_t::duration>(timeout);
+      for (std::size_t i = 0;; ++i)
+      {
+        if (auto ret = fn())
+          return ret;
+        if (clock_t::now() >= deadline)
+          return decltype(fn()){};
+        if (i >= 64)
+          std::this_thread::yield();
+      }
+    }
+  }    // namespace internal
+
   class Shared_Memory_Provider_Interface
   {
   public:
@@ -17,25 +43,67 @@ namespace wlib
     class resource_token_t
     {
     public:
+      // locks the provider for the lifetime of the token and unlocks it on destruction, the resource does not go
+      // through acquire() and release(). request() is the way to get a buffer of a pool
       resource_token_t(Shared_Memory_Provider_Interface& provider, resource_t resource)
-          : m_pro(provider)
+          : m_pro(&provider)
           , m_res(resource)
+          , m_is_locked(true)
       {
-        this->m_pro.lock();
+        provider.lock();
       }
       resource_token_t(resource_token_t const&)            = delete;
-      resource_token_t(resource_token_t&&)                 = delete;
       resource_token_t& operator=(resource_token_t const&) = delete;
-      resource_token_t& operator=(resource_token_t&&)      = delete;
+      resource_token_t(resource_token_t&& other) noexcept
+          : m_pro(std::exchange(other.m_pro, nullptr))
+          , m_res(other.m_res)
+          , m_is_locked(other.m_is_locked)
+      {
+      }
+      resource_token_t& operator=(resource_token_t&& other) noexcept
+      {
+        if (this != &other)
+        {
+          this->reset();
+          this->m_pro       = std::exchange(other.m_pro, nullptr);
+          this->m_res       = other.m_res;
+          this->m_is_locked = other.m_is_locked;
+        }
+        return *this;
+      }
 
-      ~resource_token_t() { this->m_pro.unlock(); }
+      ~resource_token_t() { this->reset(); }
 
       resource_t       get() & { return this->m_res; }
       const_resource_t get() const& { return this->m_res; }
 
     private:
-      Shared_Memory_Provider_Interface& m_pro;
+      friend Shared_Memory_Provider_Interface;
+
+      struct adopt_t
+      {
+      };
+
+      resource_token_t(adopt_t, Shared_Memory_Provider_Interface& provider, resource_t resource) noexcept
+          : m_pro(&provider)
+          , m_res(resource)
+          , m_is_locked(false)
+      {
+      }
+
+      void reset() noexcept
+      {
+        if (this->m_pro == nullptr)
+          return;
+        if (this->m_is_locked)
+          std::exchange(this->m_pro, nullptr)->unlock();
+        else
+          std::exchange(this->m_pro, nullptr)->release(this->m_res);
+      }
+
+      Shared_Memory_Provider_Interface* m_pro;
       resource_t                        m_res;
+      bool                              m_is_locked;
     };
 
     Shared_Memory_Provider_Interface(std::span<std::byte> memory)
@@ -44,15 +112,49 @@ namespace wlib
     }
     virtual ~Shared_Memory_Provider_Interface() = default;
 
-    resource_token_t request() { return resource_token_t{ *this, this->m_memory }; }
+    resource_token_t request() { return resource_token_t{ resource_token_t::adopt_t{}, *this, this->acquire() }; }
+
+    std::optional<resource_token_t> try_request() { return this->p_adopt(this->try_acquire()); }
+
+    template <typename Rep, typename Period> std::optional<resource_token_t> request_for(std::chrono::duration<Rep, Period> const& timeout)
+    {
+      return this->p_adopt(internal::try_for([this]() { return this->try_acquire(); }, timeout));
+    }
 
   private:
     friend resource_token_t;
-    virtual void         lock()   = 0;
-    virtual void         unlock() = 0;
+
+    std::optional<resource_token_t> p_adopt(std::optional<resource_t> const& resource)
+    {
+      if (!resource.has_value())
+        return std::nullopt;
+      return resource_token_t{ resource_token_t::adopt_t{}, *this, *resource };
+    }
+
+    // providers handing out more than the one span override acquire(), try_acquire() and release()
+    virtual resource_t acquire()
+    {
+      this->lock();
+      return this->m_memory;
+    }
+    virtual std::optional<resource_t> try_acquire()
+    {
+      if (!this->try_lock())
+        return std::nullopt;
+      return this->m_memory;
+    }
+    virtual void release(resource_t) { this->unlock(); }
+    virtual void lock()   = 0;
+    virtual void unlock() = 0;
+    // providers without a non blocking lock keep the default, try_request() and request_for() are unsupported then and
+    // always fail, request_for() after its timeout
+    virtual bool try_lock() { return false; }
+
     std::span<std::byte> m_memory;
   };
 
+  // request() hands out exclusive access, request_shared() read only access. providers without a reader/writer lock
+  // keep the defaults, which make shared access exclusive as well
   template <typename T> class Shared_Resource_Provider_Interface
   {
   public:
@@ -62,25 +164,101 @@ namespace wlib
     class resource_token_t
     {
     public:
+      // locks the provider for the lifetime of the token
       resource_token_t(Shared_Resource_Provider_Interface& provider, resource_t& resource)
-          : m_pro(provider)
-          , m_res(resource)
+          : m_pro(&provider)
+          , m_res(&resource)
       {
-        this->m_pro.lock();
+        provider.lock();
       }
       resource_token_t(resource_token_t const&)            = delete;
-      resource_token_t(resource_token_t&&)                 = delete;
       resource_token_t& operator=(resource_token_t const&) = delete;
-      resource_token_t& operator=(resource_token_t&&)      = delete;
+      resource_token_t(resource_token_t&& other) noexcept
+          : m_pro(std::exchange(other.m_pro, nullptr))
+          , m_res(other.m_res)
+      {
+      }
+      resource_token_t& operator=(resource_token_t&& other) noexcept
+      {
+        if (this != &other)
+        {
+          this->reset();
+          this->m_pro = std::exchange(other.m_pro, nullptr);
+          this->m_res = other.m_res;
+        }
+        return *this;
+      }
 
-      ~resource_token_t() { this->m_pro.unlock(); }
+      ~resource_token_t() { this->reset(); }
 
-      resource_t&       get() & { return this->m_res; }
-      const_resource_t& get() const& { return this->m_res; }
+      resource_t&       get() & { return *this->m_res; }
+      const_resource_t& get() const& { return *this->m_res; }
 
     private:
-      Shared_Resource_Provider_Interface& m_pro;
-      resource_t&                         m_res;
+      friend Shared_Resource_Provider_Interface;
+
+      struct adopt_t
+      {
+      };
+
+      resource_token_t(adopt_t, Shared_Resource_Provider_Interface& provider, resource_t& resource) noexcept
+          : m_pro(&provider)
+          , m_res(&resource)
+      {
+      }
+
+      void reset() noexcept
+      {
+        if (this->m_pro != nullptr)
+          std::exchange(this->m_pro, nullptr)->unlock();
+      }
+
+      Shared_Resource_Provider_Interface* m_pro;
+      resource_t*                         m_res;
+    };
+
+    class shared_token_t
+    {
+    public:
+      shared_token_t(shared_token_t const&)            = delete;
+      shared_token_t& operator=(shared_token_t const&) = delete;
+      shared_token_t(shared_token_t&& other) noexcept
+          : m_pro(std::exchange(other.m_pro, nullptr))
+          , m_res(other.m_res)
+      {
+      }
+      shared_token_t& operator=(shared_token_t&& other) noexcept
+      {
+        if (this != &other)
+        {
+          this->reset();
+          this->m_pro = std::exchange(other.m_pro, nullptr);
+          this->m_res = other.m_res;
+        }
+        return *this;
+      }
+
+      ~shared_token_t() { this->reset(); }
+
+      const_resource_t& get() const& { return *this->m_res; }
+
+    private:
+      friend Shared_Resource_Provider_Interface;
+
+      shared_token_t(Shared_Resource_Provider_Interface& provider, const_resource_t& resource) noexcept
+          : m_pro(&provider)
+          , m_res(&resource)
+      {
+      }
+
+      void reset() noexcept
+      {
+        if (this->m_pro != nullptr)
+          std::exchange(this->m_pro, nullptr)->unlock_shared();
+      }
+
+      Shared_Resource_Provider_Interface* m_pro;
+      const_resource_t*                   m_res;
     };
 
     Shared_Resource_Provider_Interface(T& resource)
@@ -89,12 +267,58 @@ namespace wlib
     }
     virtual ~Shared_Resource_Provider_Interface() = default;
 
-    resource_token_t request() { return resource_token_t{ *this, this->m_resource }; }
+    resource_token_t request()
+    {
+      this->lock();
+      return resource_token_t{ typename resource_token_t::adopt_t{}, *this, this->m_resource };
+    }
+
+    std::optional<resource_token_t> try_request()
+    {
+      if (!this->try_lock())
+        return std::nullopt;
+      return resource_token_t{ typename resource_token_t::adopt_t{}, *this, this->m_resource };
+    }
+
+    template <typename Rep, typename Period> std::optional<resource_token_t> request_for(std::chrono::duration<Rep, Period> const& timeout)
+    {
+      if (!internal::try_for([this]() { return this->try_lock(); }, timeout))
+        return std::nullopt;
+      return resource_token_t{ typename resource_token_t::adopt_t{}, *this, this->m_resource };
+    }
+
+    shared_token_t request_shared()
+    {
+      this->lock_shared();
+      return shared_token_t{ *this, this->m_resource };
+    }
+
+    std::optional<shared_token_t> try_request_shared()
+    {
+      if (!this->try_lock_shared())
+        return std::nullopt;
+      return shared_token_t{ *this, this->m_resource };
+    }
+
+    template <typename Rep, typename Period>
+    std::optional<shared_token_t> request_shared_for(std::chrono::duration<Rep, Period> const& timeout)
+    {
+      if (!internal::try_for([this]() { return this->try_lock_shared(); }, timeout))
+        return std::nullopt;
+      return shared_token_t{ *this, this->m_resource };
+    }
 
   private:
     friend resource_token_t;
+    friend shared_token_t;
     virtual void lock()   = 0;
     virtual void unlock() = 0;
+    // providers without a non blocking lock keep the default, the try and timed requests are unsupported then and
+    // always fail, the timed ones after their timeout
+    virtual bool try_lock() { return false; }
+    virtual void lock_shared() { this->lock(); }
+    virtual bool try_lock_shared() { return this->try_lock(); }
+    virtual void unlock_shared() { this->unlock(); }
     T&           m_resource;
   };
 
@@ -1,2 +1,10 @@
 #include <wlib-Provider_Interface.hpp>
 
+//
+#include <stdexcept>
+
+namespace wlib
+{
+  void internal::handle_configuration_exception(char const* what) { throw std::invalid_argument(what); }
+}    // namespace wlib
+
@@ -0,0 +1,259 @@
+#pragma once
+#ifndef WLIB_ASYNC_PUBLISHER_HPP_INCLUDED
+#define WLIB_ASYNC_PUBLISHER_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stop_token>
+#include <thread>
+#include <vector>
+#include <wlib-Container.hpp>
+#include <wlib-Publisher.hpp>
+
+namespace wlib::publisher
+{
+  enum class overflow_policy_t
+  {
+    drop_oldest,
+    drop_newest,
+    block,
+  };
+
+  struct subscriber_metrics_t
+  {
+    bool          is_active   = false;
+    std::size_t   pending     = 0;
+    std::size_t   max_pending = 0;
+    std::uint64_t delivered   = 0;
+    std::uint64_t dropped     = 0;
+  };
+
+  class Dispatchable_Interface
+  {
+  public:
+    virtual ~Dispatchable_Interface() = default;
+
+    virtual std::size_t   dispatch()                            = 0;
+    virtual std::uint32_t get_event_sequence() const noexcept   = 0;
+    virtual void          wait_for_event(std::uint32_t old_seq) = 0;
+    virtual void          wake_all()                            = 0;
+  };
+
+  // every subscriber gets its own bounded queue, notify() is called from the threads calling dispatch().
+  // publish() must not be called concurrently, the queues are single producer single consumer
+  template <typename T, std::size_t MaxSubs, std::size_t QueueDepth>
+    requires(MaxSubs > 0 && QueueDepth > 0 && std::is_copy_constructible_v<T>)
+  class Async_Publisher final
+      : public Publisher_Interface<T>
+      , public Dispatchable_Interface
+  {
+    using notifyable_t = typename Publisher_Interface<T>::Notifyable_Interface;
+
+  public:
+    using payload_t = T;
+
+    explicit Async_Publisher(overflow_policy_t policy = overflow_policy_t::drop_oldest) noexcept
+        : m_policy{ policy }
+    {
+    }
+
+    void publish(payload_t const& value)
+    {
+      {
+        internal::epoch_t::read_guard_t guard{ this->m_epoch };
+
+        std::size_t const end = this->m_end.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < end; ++i)
+        {
+          slot_t&             slot = this->m_slots[i];
+          notifyable_t* const sub  = slot.sub.load(std::memory_order_acquire);
+          if (sub != nullptr)
+            this->p_enqueue(slot, *sub, value);
+        }
+      }
+      this->wake_all();
+    }
+
+    std::size_t dispatch() override
+    {
+      internal::epoch_t::read_guard_t guard{ this->m_epoch };
+
+      std::size_t       ret = 0;
+      std::size_t const end = this->m_end.load(std::memory_order_acquire);
+      for (std::size_t i = 0; i < end; ++i)
+      {
+        slot_t& slot = this->m_slots[i];
+        if (slot.delivering.test_and_set(std::memory_order_acquire))
+          continue;
+
+        flag_guard_t        delivering{ slot.delivering };
+        notifyable_t* const sub = slot.sub.load(std::memory_order_acquire);
+        if (sub == nullptr)
+          continue;
+
+        while (auto value = p_pop(slot))
+        {
+          sub->notify(*value);
+          slot.delivered.fetch_add(1, std::memory_order_relaxed);
+          ++ret;
+        }
+      }
+      return ret;
+    }
+
+    std::uint32_t get_event_sequence() const noexcept override { return this->m_seq.load(std::memory_order_acquire); }
+    void          wait_for_event(std::uint32_t old_seq) override { this->m_seq.wait(old_seq, std::memory_order_acquire); }
+    void          wake_all() override
+    {
+      this->m_seq.fetch_add(1, std::memory_order_release);
+      this->m_seq.notify_all();
+    }
+
+    constexpr std::size_t get_number_of_slots() const noexcept { return MaxSubs; }
+
+    subscriber_metrics_t get_metrics(std::size_t slot_idx) const noexcept
+    {
+      slot_t const& slot = this->m_slots[slot_idx];
+      return {
+        .is_active   = slot.sub.load(std::memory_order_relaxed) != nullptr,
+        .pending     = slot.queue.get_number_of_used_entries(),
+        .max_pending = slot.max_pending.load(std::memory_order_relaxed),
+        .delivered   = slot.delivered.load(std::memory_order_relaxed),
+        .dropped     = slot.dropped.load(std::memory_order_relaxed),
+      };
+    }
+
+  private:
+    struct slot_t
+    {
+      std::atomic<notifyable_t*>                   sub         = nullptr;
+      wlib::container::SPSC<payload_t, QueueDepth> queue       = {};
+      std::atomic_flag                             consumer    = ATOMIC_FLAG_INIT;
+      std::atomic_flag                             delivering  = ATOMIC_FLAG_INIT;
+      std::atomic<std::size_t>                     max_pending = 0;
+      std::atomic<std::uint64_t>                   delivered   = 0;
+      std::atomic<std::uint64_t>                   dropped     = 0;
+    };
+
+    class flag_guard_t
+    {
+    public:
+      explicit flag_guard_t(std::atomic_flag& flag) noexcept
+          : m_flag{ flag }
+      {
+      }
+      flag_guard_t(flag_guard_t const&)            = delete;
+      flag_guard_t(flag_guard_t&&)                 = delete;
+      flag_guard_t& operator=(flag_guard_t const&) = delete;
+      flag_guard_t& operator=(flag_guard_t&&)      = delete;
+      ~flag_guard_t() { this->m_flag.clear(std::memory_order_release); }
+
+    private:
+      std::atomic_flag& m_flag;
+    };
+
+    static std::optional<payload_t> p_pop(slot_t& slot)
+    {
+      internal::writer_lock_t lock{ slot.consumer };
+      return slot.queue.pop_front();
+    }
+
+    void p_enqueue(slot_t& slot, notifyable_t& sub, payload_t const& value)
+    {
+      while (!slot.queue.push_back(value))
+      {
+        switch (this->m_policy)
+        {
+        case overflow_policy_t::drop_newest:
+          slot.dropped.fetch_add(1, std::memory_order_relaxed);
+          return;
+
+        case overflow_policy_t::drop_oldest:
+          if (p_pop(slot).has_value())
+            slot.dropped.fetch_add(1, std::memory_order_relaxed);
+          break;
+
+        case overflow_policy_t::block:
+          if (slot.sub.load(std::memory_order_acquire) != &sub)
+            return;
+          this->wake_all();
+          std::this_thread::yield();
+          break;
+        }
+      }
+
+      std::size_t const pending = slot.queue.get_number_of_used_entries();
+      if (slot.max_pending.load(std::memory_order_relaxed) < pending)
+        slot.max_pending.store(pending, std::memory_order_relaxed);
+    }
+
+    bool try_add_subscriber(notifyable_t& sub) override
+    {
+      internal::writer_lock_t lock{ this->m_writer };
+      for (std::size_t i = 0; i < MaxSubs; ++i)
+      {
+        slot_t& slot = this->m_slots[i];
+        if (slot.sub.load() != nullptr)
+          continue;
+
+        slot.max_pending.store(0);
+        slot.delivered.store(0);
+        slot.dropped.store(0);
+        slot.sub.store(&sub);
+        if (this->m_end.load() <= i)
+          this->m_end.store(i + 1);
+        return true;
+      }
+      return false;
+    }
+
+    void remove_subscriber(notifyable_t& sub) override
+    {
+      internal::writer_lock_t lock{ this->m_writer };
+      std::size_t             end = this->m_end.load();
+      for (std::size_t i = 0; i < end; ++i)
+      {
+        slot_t& slot = this->m_slots[i];
+        if (slot.sub.load() != &sub)
+          continue;
+
+        slot.sub.store(nullptr);
+        while (end > 0 && this->m_slots[end - 1].sub.load() == nullptr)
+          --end;
+        this->m_end.store(end);
+        this->m_epoch.synchronize();
+
+        while (p_pop(slot).has_value())
+          ;
+        return;
+      }
+    }
+
+    overflow_policy_t          m_policy;
+    slot_t                     m_slots[MaxSubs] = {};
+    std::atomic<std::size_t>   m_end            = 0;
+    std::atomic_flag           m_writer         = ATOMIC_FLAG_INIT;
+    internal::epoch_t          m_epoch          = {};
+    std::atomic<std::uint32_t> m_seq            = 0;
+  };
+
+  class Dispatcher_Pool
+  {
+  public:
+    Dispatcher_Pool(Dispatchable_Interface& target, std::size_t number_of_workers);
+    Dispatcher_Pool(Dispatcher_Pool const&)            = delete;
+    Dispatcher_Pool(Dispatcher_Pool&&)                 = delete;
+    Dispatcher_Pool& operator=(Dispatcher_Pool const&) = delete;
+    Dispatcher_Pool& operator=(Dispatcher_Pool&&)      = delete;
+    ~Dispatcher_Pool();
+
+  private:
+    static void worker(std::stop_token stop, Dispatchable_Interface& target);
+
+    Dispatchable_Interface&   m_target;
+    std::vector<std::jthread> m_workers;
+  };
+}    // namespace wlib::publisher
+
+#endif
@@ -2,6 +2,11 @@
 #ifndef WLIB_PUBLISHER_HPP_INCLUDED
 #define WLIB_PUBLISHER_HPP_INCLUDED
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <span>
+#include <thread>
 #include <wlib-Callback.hpp>
 
 namespace wlib::publisher
@@ -9,8 +14,148 @@ namespace wlib::publisher
   namespace error
   {
     void handle_subscription_exception();
+    void handle_batch_overflow_exception();
+    void handle_prefix_exception();
   }
 
+  namespace internal
+  {
+    // epoch based reclamation: readers never block, writers wait until every reader that might still see the old state has left
+    class epoch_t
+    {
+    public:
+      class read_guard_t
+      {
+      public:
+        explicit read_guard_t(epoch_t& obj) noexcept
+            : m_readers{ &obj.enter() }
+        {
+        }
+        read_guard_t(read_guard_t const&)            = delete;
+        read_guard_t(read_guard_t&&)                 = delete;
+        read_guard_t& operator=(read_guard_t const&) = delete;
+        read_guard_t& operator=(read_guard_t&&)      = delete;
+        ~read_guard_t() { this->m_readers->fetch_sub(1); }
+
+      private:
+        std::atomic<std::size_t>* m_readers;
+      };
+
+      void synchronize() noexcept
+      {
+        std::size_t const e = this->m_epoch.load();
+        this->m_epoch.store(e + 1);
+        while (this->m_readers[e & 1].load() != 0)
+          std::this_thread::yield();
+      }
+
+    private:
+      std::atomic<std::size_t>& enter() noexcept
+      {
+        while (true)
+        {
+          std::size_t const         e       = this->m_epoch.load();
+          std::atomic<std::size_t>& readers = this->m_readers[e & 1];
+          readers.fetch_add(1);
+          if (this->m_epoch.load() == e)
+            return readers;
+          readers.fetch_sub(1);
+        }
+      }
+
+      std::atomic<std::size_t> m_epoch      = 0;
+      std::atomic<std::size_t> m_readers[2] = {};
+    };
+
+    class writer_lock_t
+    {
+    public:
+      explicit writer_lock_t(std::atomic_flag& flag) noexcept
+          : m_flag{ flag }
+      {
+        while (this->m_flag.test_and_set(std::memory_order_acquire))
+          std::this_thread::yield();
+      }
+      writer_lock_t(writer_lock_t const&)            = delete;
+      writer_lock_t(writer_lock_t&&)                 = delete;
+      writer_lock_t& operator=(writer_lock_t const&) = delete;
+      writer_lock_t& operator=(writer_lock_t&&)      = delete;
+      ~writer_lock_t() { this->m_flag.clear(std::memory_order_release); }
+
+    private:
+      std::atomic_flag& m_flag;
+    };
+
+    // fixed capacity subscriber list, iterating never takes a lock and subscribers may join or leave concurrently.
+    // a subscriber must not be removed from within one of its own notifications, remove() would wait for itself
+    template <typename Tsub, std::size_t N>
+      requires(N > 0)
+    class subscriber_list_t
+    {
+    public:
+      bool try_add(Tsub& sub) noexcept
+      {
+        writer_lock_t lock{ this->m_writer };
+        for (std::size_t i = 0; i < N; ++i)
+        {
+          if (this->m_subs[i].load() != nullptr)
+            continue;
+
+          this->m_subs[i].store(&sub);
+          if (this->m_end.load() <= i)
+            this->m_end.store(i + 1);
+          return true;
+        }
+        return false;
+      }
+
+      void remove(Tsub& sub) noexcept
+      {
+        writer_lock_t lock{ this->m_writer };
+        std::size_t   end = this->m_end.load();
+        for (std::size_t i = 0; i < end; ++i)
+        {
+          if (this->m_subs[i].load() != &sub)
+            continue;
+
+          this->m_subs[i].store(nullptr);
+          while (end > 0 && this->m_subs[end - 1].load() == nullptr)
+            --end;
+          this->m_end.store(end);
+          this->m_epoch.synchronize();
+          return;
+        }
+      }
+
+      template <typename F> void for_each(F&& fnc)
+      {
+        epoch_t::read_guard_t guard{ this->m_epoch };
+
+        std::size_t const end = this->m_end.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < end; ++i)
+        {
+          Tsub* const sub = this->m_subs[i].load(std::memory_order_acquire);
+          if (sub != nullptr)
+            fnc(*sub);
+        }
+      }
+
+      std::size_t get_number_of_subscribers() const noexcept
+      {
+        std::size_t ret = 0;
+        for (std::atomic<Tsub*> const& sub : this->m_subs)
+          ret += sub.load(std::memory_order_relaxed) != nullptr ? 1 : 0;
+        return ret;
+      }
+
+    private:
+      std::atomic<Tsub*>       m_subs[N] = {};
+      std::atomic<std::size_t> m_end     = 0;
+      std::atomic_flag         m_writer  = ATOMIC_FLAG_INIT;
+      epoch_t                  m_epoch   = {};
+    };
+  }    // namespace internal
+
   template <typename T> class Publisher_Interface
   {
   public:
@@ -21,8 +166,16 @@ namespace wlib::publisher
     public:
       virtual ~Notifyable_Interface()       = default;
       virtual void notify(payload_t const&) = 0;
+
+      virtual void notify_batch(std::span<payload_t const> payloads)
+      {
+        for (payload_t const& payload : payloads)
+          this->notify(payload);
+      }
     };
 
+    // classes implementing notify() unsubscribe in their own destructor, before their part of the object is gone. the
+    // base destructor only catches the ones that do not, a concurrent publish may then reach a partly destroyed object
     class Subscription_Interface: private Publisher_Interface::Notifyable_Interface
     {
     public:
@@ -81,6 +234,8 @@ namespace wlib::publisher
     };
 
   public:
+    // classes implementing notify() unsubscribe in their own destructor, before their part of the object is gone. the
+    // base destructor only catches the ones that do not, a concurrent publish may then reach a partly destroyed object
     class Subscription_Interface: private Publisher_Interface<void>::Notifyable_Interface
     {
     public:
@@ -125,6 +280,135 @@ namespace wlib::publisher
     virtual void remove_subscriber(Notifyable_Interface& sub)  = 0;
   };
 
+  template <typename T, std::size_t MaxSubs> class Publisher final: public Publisher_Interface<T>
+  {
+    using notifyable_t = typename Publisher_Interface<T>::Notifyable_Interface;
+
+  public:
+    using payload_t = T;
+
+    void publish(payload_t const& value)
+    {
+      this->m_subs.for_each([&value](notifyable_t& sub) { sub.notify(value); });
+    }
+
+    void publish_batch(std::span<payload_t const> values)
+    {
+      if (values.empty())
+        return;
+      this->m_subs.for_each([values](notifyable_t& sub) { sub.notify_batch(values); });
+    }
+
+    std::size_t get_number_of_subscribers() const noexcept { return this->m_subs.get_number_of_subscribers(); }
+
+  private:
+    bool try_add_subscriber(notifyable_t& sub) override { return this->m_subs.try_add(sub); }
+    void remove_subscriber(notifyable_t& sub) override { return this->m_subs.remove(sub); }
+
+    internal::subscriber_list_t<notifyable_t, MaxSubs> m_subs;
+  };
+
+  // collects events and hands them to the subscribers as one batch once BatchSize events are pending or the
+  // oldest pending event is older than the time window. poll() flushes an expired window without a new event.
+  // publish(), poll() and flush() must not be called concurrently. a subscriber may publish from its callback, those
+  // events are collected in a second buffer and delivered after the current batch, at most BatchSize per batch
+  template <typename T, std::size_t MaxSubs, std::size_t BatchSize, typename Tclock = std::chrono::steady_clock>
+    requires(BatchSize > 0 && std::is_default_constructible_v<T> && std::is_copy_assignable_v<T>)
+  class Batching_Publisher final: public Publisher_Interface<T>
+  {
+    using notifyable_t = typename Publisher_Interface<T>::Notifyable_Interface;
+
+  public:
+    using payload_t  = T;
+    using duration_t = typename Tclock::duration;
+
+    explicit Batching_Publisher(duration_t window = duration_t::max()) noexcept
+        : m_window{ window }
+    {
+    }
+
+    void publish(payload_t const& value)
+    {
+      if (this->m_cnt == BatchSize)
+        return error::handle_batch_overflow_exception();
+      if (this->m_cnt == 0)
+        this->m_first = Tclock::now();
+
+      this->m_buffer[this->m_active][this->m_cnt++] = value;
+      if (this->m_cnt == BatchSize || this->is_window_expired())
+        this->flush();
+    }
+
+    void poll()
+    {
+      if (this->m_cnt != 0 && this->is_window_expired())
+        this->flush();
+    }
+
+    void flush()
+    {
+      // called from a subscriber, the running flush delivers the new events once the current batch is done
+      if (this->m_is_flushing)
+        return;
+
+      this->m_is_flushing = true;
+      try
+      {
+        while (this->m_cnt != 0)
+        {
+          std::span<payload_t const> const batch{ this->m_buffer[this->m_active], this->m_cnt };
+          this->m_active ^= 1;
+          this->m_cnt = 0;
+          this->m_subs.for_each([batch](notifyable_t& sub) { sub.notify_batch(batch); });
+        }
+      }
+      catch (...)
+      {
+        this->m_is_flushing = false;
+        throw;
+      }
+      this->m_is_flushing = false;
+    }
+
+    std::size_t get_number_of_pending_events() const noexcept { return this->m_cnt; }
+    std::size_t get_number_of_subscribers() const noexcept { return this->m_subs.get_number_of_subscribers(); }
+
+  private:
+    bool is_window_expired() const { return this->m_window != duration_t::max() && Tclock::now() - this->m_first >= this->m_window; }
+
+    bool try_add_subscriber(notifyable_t& sub) override { return this->m_subs.try_add(sub); }
+    void remove_subscriber(notifyable_t& sub) override { return this->m_subs.remove(sub); }
+
+    internal::subscriber_list_t<notifyable_t, MaxSubs> m_subs;
+    duration_t                                         m_window;
+    typename Tclock::time_point                        m_first                = {};
+    std::size_t                                        m_cnt                  = 0;
+    std::size_t                                        m_active               = 0;
+    bool                                               m_is_flushing          = false;
+    payload_t                                          m_buffer[2][BatchSize] = {};
+  };
+
+  template <std::size_t MaxSubs> class Publisher<void, MaxSubs> final: public Publisher_Interface<void>
+  {
+    using notifyable_t = Publisher_Interface<void>::Notifyable_Interface;
+
+  public:
+    using payload_t = void;
+
+    void publish()
+    {
+      this->m_subs.for_each([](notifyable_t& sub) { sub.notify(); });
+    }
+
+    std::size_t get_number_of_subscribers() const noexcept { return this->m_subs.get_number_of_subscribers(); }
+
+  private:
+    bool try_add_subscriber(notifyable_t& sub) override { return this->m_subs.try_add(sub); }
+    void remove_subscriber(notifyable_t& sub) override { return this->m_subs.remove(sub); }
+
+    internal::subscriber_list_t<notifyable_t, MaxSubs> m_subs;
+  };
+
   template <typename Tpub> class CallbackSubscriber: public Publisher_Interface<Tpub>::Subscription_Interface
   {
   public:
@@ -132,12 +416,35 @@ namespace wlib::publisher
         : m_target_callback(target_callback)
     {
     }
+    ~CallbackSubscriber() override { this->unsubscribe(); }
 
   private:
-    void                               notify(Tpub const& val) override { return this->m_target_callback(val); }
+    void notify(Tpub const& val) override { return this->m_target_callback(val); }
+    void notify_batch(std::span<Tpub const> vals) override
+    {
+      for (Tpub const& val : vals)
+        this->m_target_callback(val);
+    }
+
     wlib::Callback<void(Tpub const&)>& m_target_callback;
   };
 
+  template <typename Tpub> class BatchCallbackSubscriber: public Publisher_Interface<Tpub>::Subscription_Interface
+  {
+  public:
+    BatchCallbackSubscriber(wlib::Callback<void(std::span<Tpub const>)>& target_callback)
+        : m_target_callback(target_callback)
+    {
+    }
+    ~BatchCallbackSubscriber() override { this->unsubscribe(); }
+
+  private:
+    void notify(Tpub const& val) override { return this->m_target_callback(std::span<Tpub const>(&val, 1)); }
+    void notify_batch(std::span<Tpub const> vals) override { return this->m_target_callback(vals); }
+
+    wlib::Callback<void(std::span<Tpub const>)>& m_target_callback;
+  };
+
   template <> class CallbackSubscriber<void>: public Publisher_Interface<void>::Subscription_Interface
   {
   public:
@@ -145,6 +452,7 @@ namespace wlib::publisher
         : m_target_callback(target_callback)
     {
     }
+    ~CallbackSubscriber() override { this->unsubscribe(); }
 
   private:
     void                    notify() override { return this->m_target_callback(); }
@@ -161,6 +469,7 @@ namespace wlib::publisher
         , m_mem_fuc(mem_fuc)
     {
     }
+    ~Memberfunction_CallbackSubscriber() override { this->unsubscribe(); }
 
   private:
     void notify(Tpub const& val) override { return (this->m_obj.*m_mem_fuc)(val); }
@@ -179,6 +488,7 @@ namespace wlib::publisher
         , m_mem_fuc(mem_fuc)
     {
     }
+    ~Memberfunction_CallbackSubscriber() override { this->unsubscribe(); }
 
   private:
     void notify() override { return (this->m_obj.*m_mem_fuc)(); }
@@ -187,6 +497,41 @@ namespace wlib::publisher
     mem_fnc_t m_mem_fuc;
   };
 
+  template <typename Tpub> class DelegateSubscriber: public Publisher_Interface<Tpub>::Subscription_Interface
+  {
+  public:
+    constexpr DelegateSubscriber(wlib::delegate<void(Tpub const&)> target)
+        : m_target(target)
+    {
+    }
+    ~DelegateSubscriber() override { this->unsubscribe(); }
+
+  private:
+    void notify(Tpub const& val) override { return this->m_target(val); }
+    void notify_batch(std::span<Tpub const> vals) override
+    {
+      for (Tpub const& val : vals)
+        this->m_target(val);
+    }
+
+    wlib::delegate<void(Tpub const&)> m_target;
+  };
+
+  template <> class DelegateSubscriber<void>: public Publisher_Interface<void>::Subscription_Interface
+  {
+  public:
+    constexpr DelegateSubscriber(wlib::delegate<void()> target)
+        : m_target(target)
+    {
+    }
+    ~DelegateSubscriber() override { this->unsubscribe(); }
+
+  private:
+    void notify() override { return this->m_target(); }
+
+    wlib::delegate<void()> m_target;
+  };
+
   template <typename Tpub, typename Tsub> class TransformationSubscriber: public Publisher_Interface<Tpub>::Subscription_Interface
   {
   public:
@@ -196,6 +541,7 @@ namespace wlib::publisher
         , m_transformer_callback(transformer_callback)
     {
     }
+    ~TransformationSubscriber() override { this->unsubscribe(); }
 
   private:
     void                               notify(Tpub const& val) override { return this->m_transformer_callback(this->m_target_callback, val); }
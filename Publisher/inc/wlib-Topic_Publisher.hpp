@@ -0,0 +1,247 @@
+#pragma once
+#ifndef WLIB_TOPIC_PUBLISHER_HPP_INCLUDED
+#define WLIB_TOPIC_PUBLISHER_HPP_INCLUDED
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <wlib-Publisher.hpp>
+
+namespace wlib::publisher
+{
+  namespace internal
+  {
+    template <typename T> struct topic_traits
+    {
+      using char_t                          = char;
+      static constexpr bool supports_prefix = false;
+    };
+    template <typename C, typename Ttraits> struct topic_traits<std::basic_string_view<C, Ttraits>>
+    {
+      using char_t                          = C;
+      static constexpr bool supports_prefix = true;
+    };
+  }    // namespace internal
+
+  // routes every event only to the subscribers of its topic. for string_view topics a subscription may also cover all
+  // topics starting with a prefix that ends on a separator, e.g. "sensor/12/" receives "sensor/12/temperature".
+  // keys are stored by value, for view types the referenced characters have to outlive the subscription.
+  // unsubscribe() waits for every running publish(), so a subscriber must not unsubscribe or be destroyed from within
+  // its own notify(), it would wait for itself
+  template <typename Tkey, typename T, std::size_t MaxTopics, typename Thash = std::hash<Tkey>>
+    requires(MaxTopics > 0)
+  class Topic_Publisher
+  {
+  public:
+    using key_t     = Tkey;
+    using payload_t = T;
+    using char_t    = typename internal::topic_traits<key_t>::char_t;
+
+    static constexpr bool supports_prefix = internal::topic_traits<key_t>::supports_prefix;
+
+    // classes implementing notify() unsubscribe in their own destructor, the base destructor runs after their part of
+    // the object is gone and a concurrent publish() could still reach it
+    class Subscription_Interface
+    {
+    public:
+      Subscription_Interface()                                         = default;
+      Subscription_Interface(Subscription_Interface const&)            = delete;
+      Subscription_Interface(Subscription_Interface&&)                 = delete;
+      Subscription_Interface& operator=(Subscription_Interface const&) = delete;
+      Subscription_Interface& operator=(Subscription_Interface&&)      = delete;
+      virtual ~Subscription_Interface() { this->unsubscribe(); }
+
+      void subscribe(Topic_Publisher& pub, key_t const& topic) & { return this->p_subscribe(pub, topic, false); }
+
+      void subscribe_prefix(Topic_Publisher& pub, key_t const& prefix) &
+        requires(supports_prefix)
+      {
+        return this->p_subscribe(pub, prefix, true);
+      }
+
+      void unsubscribe()
+      {
+        if (this->m_pub == nullptr)
+          return;
+
+        this->m_pub->remove_subscriber(*this);
+        this->m_pub = nullptr;
+      }
+
+      bool is_subscribed() const noexcept { return this->m_pub != nullptr; }
+
+    private:
+      virtual void notify(key_t const& topic, payload_t const& value) = 0;
+
+      void p_subscribe(Topic_Publisher& pub, key_t const& key, bool is_prefix)
+      {
+        if (this->is_subscribed())
+          return error::handle_subscription_exception();
+        if constexpr (supports_prefix)
+        {
+          // publish() only looks up prefixes ending on a separator, any other prefix would never match
+          if (is_prefix && (key.empty() || key.back() != pub.m_separator))
+            return error::handle_prefix_exception();
+        }
+
+        this->m_key       = key;
+        this->m_is_prefix = is_prefix;
+        if (!pub.try_add_subscriber(*this))
+          return error::handle_subscription_exception();
+        this->m_pub = &pub;
+      }
+
+      friend Topic_Publisher;
+
+      Topic_Publisher*                     m_pub       = nullptr;
+      key_t                                m_key       = {};
+      bool                                 m_is_prefix = false;
+      std::atomic<Subscription_Interface*> m_next      = nullptr;
+    };
+
+    explicit Topic_Publisher(Thash hash = {}, char_t separator = char_t('/'))
+        : m_hash{ hash }
+        , m_separator{ separator }
+    {
+    }
+    Topic_Publisher(Topic_Publisher const&)            = delete;
+    Topic_Publisher(Topic_Publisher&&)                 = delete;
+    Topic_Publisher& operator=(Topic_Publisher const&) = delete;
+    Topic_Publisher& operator=(Topic_Publisher&&)      = delete;
+    virtual ~Topic_Publisher()                         = default;
+
+    void publish(key_t const& topic, payload_t const& value)
+    {
+      internal::epoch_t::read_guard_t guard{ this->m_epoch };
+
+      this->p_dispatch(this->m_exact, topic, topic, value);
+
+      if constexpr (supports_prefix)
+      {
+        if (this->m_number_of_prefix_subs.load(std::memory_order_acquire) == 0)
+          return;
+
+        for (std::size_t i = 0; i < topic.size(); ++i)
+        {
+          if (topic[i] == this->m_separator)
+            this->p_dispatch(this->m_prefix, topic.substr(0, i + 1), topic, value);
+        }
+      }
+    }
+
+  private:
+    using sub_t = Subscription_Interface;
+
+    static constexpr std::size_t table_size = std::bit_ceil(2 * MaxTopics);
+
+    struct bucket_t
+    {
+      std::atomic<sub_t*>      head    = nullptr;
+      std::atomic<std::size_t> hash    = 0;
+      std::atomic<bool>        is_used = false;
+    };
+
+    using table_t = bucket_t[table_size];
+
+    bucket_t* p_find(table_t& table, key_t const& key, std::size_t hash) noexcept
+    {
+      for (std::size_t i = 0, idx = hash; i < table_size; ++i, ++idx)
+      {
+        bucket_t& bucket = table[idx & (table_size - 1)];
+        if (!bucket.is_used.load(std::memory_order_acquire))
+          return nullptr;
+
+        sub_t const* const head = bucket.head.load(std::memory_order_acquire);
+        if (head != nullptr && bucket.hash.load(std::memory_order_relaxed) == hash && head->m_key == key)
+          return &bucket;
+      }
+      return nullptr;
+    }
+
+    void p_dispatch(table_t& table, key_t const& key, key_t const& topic, payload_t const& value)
+    {
+      bucket_t* const bucket = this->p_find(table, key, this->m_hash(key));
+      if (bucket == nullptr)
+        return;
+
+      for (sub_t* sub = bucket->head.load(std::memory_order_acquire); sub != nullptr; sub = sub->m_next.load(std::memory_order_acquire))
+        sub->notify(topic, value);
+    }
+
+    bool try_add_subscriber(sub_t& sub) noexcept
+    {
+      internal::writer_lock_t lock{ this->m_writer };
+
+      table_t&          table = sub.m_is_prefix ? this->m_prefix : this->m_exact;
+      std::size_t const hash  = this->m_hash(sub.m_key);
+
+      if (bucket_t* const bucket = this->p_find(table, sub.m_key, hash); bucket != nullptr)
+      {
+        sub.m_next.store(bucket->head.load());
+        bucket->head.store(&sub);
+        this->p_count(sub, true);
+        return true;
+      }
+
+      for (std::size_t i = 0, idx = hash; i < table_size; ++i, ++idx)
+      {
+        bucket_t& bucket = table[idx & (table_size - 1)];
+        if (bucket.head.load() != nullptr)
+          continue;
+
+        sub.m_next.store(nullptr);
+        bucket.hash.store(hash);
+        bucket.head.store(&sub);
+        bucket.is_used.store(true);
+        this->p_count(sub, true);
+        return true;
+      }
+      return false;
+    }
+
+    void remove_subscriber(sub_t& sub) noexcept
+    {
+      internal::writer_lock_t lock{ this->m_writer };
+
+      table_t&        table  = sub.m_is_prefix ? this->m_prefix : this->m_exact;
+      bucket_t* const bucket = this->p_find(table, sub.m_key, this->m_hash(sub.m_key));
+      if (bucket == nullptr)
+        return;
+
+      for (std::atomic<sub_t*>* link = &bucket->head; link->load() != nullptr; link = &link->load()->m_next)
+      {
+        if (link->load() != &sub)
+          continue;
+
+        link->store(sub.m_next.load());
+        this->p_count(sub, false);
+        this->m_epoch.synchronize();
+        return;
+      }
+    }
+
+    void p_count(sub_t const& sub, bool added) noexcept
+    {
+      if (!sub.m_is_prefix)
+        return;
+
+      if (added)
+        this->m_number_of_prefix_subs.fetch_add(1);
+      else
+        this->m_number_of_prefix_subs.fetch_sub(1);
+    }
+
+    [[no_unique_address]] Thash m_hash;
+    char_t                      m_separator;
+    table_t                     m_exact                 = {};
+    table_t                     m_prefix                = {};
+    std::atomic<std::size_t>    m_number_of_prefix_subs = 0;
+    std::atomic_flag            m_writer                = ATOMIC_FLAG_INIT;
+    internal::epoch_t           m_epoch                 = {};
+  };
+}    // namespace wlib::publisher
+
+#endif
@@ -0,0 +1,30 @@
+#include <wlib-Async_Publisher.hpp>
+
+namespace wlib::publisher
+{
+  Dispatcher_Pool::Dispatcher_Pool(Dispatchable_Interface& target, std::size_t number_of_workers)
+      : m_target{ target }
+  {
+    this->m_workers.reserve(number_of_workers);
+    for (std::size_t i = 0; i < number_of_workers; ++i)
+      this->m_workers.emplace_back(&Dispatcher_Pool::worker, std::ref(this->m_target));
+  }
+
+  Dispatcher_Pool::~Dispatcher_Pool()
+  {
+    for (std::jthread& worker : this->m_workers)
+      worker.request_stop();
+    this->m_target.wake_all();
+    this->m_workers.clear();
+  }
+
+  void Dispatcher_Pool::worker(std::stop_token stop, Dispatchable_Interface& target)
+  {
+    while (!stop.stop_requested())
+    {
+      std::uint32_t const seq = target.get_event_sequence();
+      if (target.dispatch() == 0 && !stop.stop_requested())
+        target.wait_for_event(seq);
+    }
+  }
+}    // namespace wlib::publisher
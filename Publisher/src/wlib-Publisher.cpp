@@ -5,4 +5,6 @@
 namespace wlib::publisher::error
 {
   void handle_subscription_exception() { throw std::out_of_range("unable to subscribe to publisher"); }
+  void handle_batch_overflow_exception() { throw std::length_error("events published during a flush exceed the batch size"); }
+  void handle_prefix_exception() { throw std::invalid_argument("topic prefix has to end with the separator"); }
 }    // namespace wlib::blob
@@ -0,0 +1,92 @@
+#pragma once
+#ifndef WLIB_SPI_BUS_ARBITER_HPP_INCLUDED
+#define WLIB_SPI_BUS_ARBITER_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <wlib-SPI_Interface.hpp>
+
+namespace wlib::SPI
+{
+  enum class bus_priority_t : std::uint8_t
+  {
+    low,
+    normal,
+    high,
+    realtime,
+  };
+
+  // shares one hardware between threads. every client uses its own port_t in place of the hardware, e.g. with a
+  // Channel_Provider. enable() on a port waits for the bus and disable() hands it on, the hardware itself is only
+  // reconfigured when the next owner needs a different configuration.
+  // an uncontended bus is taken and released with a single compare exchange. waiters are served by priority and in
+  // ticket order within one priority, a higher priority always goes first
+  class Bus_Arbiter
+  {
+  public:
+    static constexpr std::size_t number_of_priorities = 4;
+
+    class port_t final: public Hardware_Interface
+    {
+    public:
+      explicit port_t(Bus_Arbiter& arbiter, bus_priority_t priority = bus_priority_t::normal) noexcept
+          : m_arbiter{ arbiter }
+          , m_priority{ priority }
+      {
+      }
+
+    private:
+      void enable(SPI_configuration_t const& cfg) override;
+      void disable() override;
+      void transcieve(std::byte const* tx, std::byte* rx, std::size_t const& len) override;
+      void transcieve(std::span<tx_segment_t const> tx, std::span<rx_segment_t const> rx) override;
+
+      Bus_Arbiter&   m_arbiter;
+      bus_priority_t m_priority;
+    };
+
+    explicit Bus_Arbiter(Hardware_Interface& hw) noexcept
+        : m_hw{ hw }
+    {
+    }
+    Bus_Arbiter(Bus_Arbiter const&)            = delete;
+    Bus_Arbiter(Bus_Arbiter&&)                 = delete;
+    Bus_Arbiter& operator=(Bus_Arbiter const&) = delete;
+    Bus_Arbiter& operator=(Bus_Arbiter&&)      = delete;
+    ~Bus_Arbiter();
+
+    // waits for the bus and disables the hardware, e.g. before entering a low power mode
+    void power_down();
+
+    std::size_t get_number_of_reconfigurations() const noexcept { return this->m_number_of_reconfigurations.load(std::memory_order_relaxed); }
+    std::size_t get_number_of_contentions() const noexcept { return this->m_number_of_contentions.load(std::memory_order_relaxed); }
+
+  private:
+    // bit 0 marks the bus as owned, the remaining bits count the waiters
+    static constexpr std::uint32_t owned  = 1;
+    static constexpr std::uint32_t waiter = 2;
+
+    void p_acquire(bus_priority_t priority);
+    void p_release();
+    void p_configure(SPI_configuration_t const& cfg);
+    void p_lock() noexcept;
+    void p_unlock() noexcept;
+
+    Hardware_Interface&                m_hw;
+    std::optional<SPI_configuration_t> m_active = std::nullopt;
+
+    std::atomic<std::uint32_t> m_state = 0;
+    std::atomic<std::uint64_t> m_grant = UINT64_MAX;
+    std::atomic_flag           m_lock  = ATOMIC_FLAG_INIT;
+    // guarded by m_lock
+    std::uint32_t m_next_ticket[number_of_priorities] = {};
+    std::uint32_t m_serving[number_of_priorities]     = {};
+
+    std::atomic<std::size_t> m_number_of_reconfigurations = 0;
+    std::atomic<std::size_t> m_number_of_contentions      = 0;
+  };
+}    // namespace wlib::SPI
+
+#endif
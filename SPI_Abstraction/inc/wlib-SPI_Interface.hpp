@@ -2,8 +2,10 @@
 #ifndef WLIB_SPI_INTERFACE_HPP_INCLUDED
 #define WLIB_SPI_INTERFACE_HPP_INCLUDED
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <span>
 
 namespace wlib::SPI
 {
@@ -11,6 +13,8 @@ namespace wlib::SPI
   class Hardware_handle_t;
   class Channel_handle_t;
   class Connection_handle_t;
+  class Transaction_Queue;
+  class Bus_Arbiter;
 
   class SPI_configuration_t
   {
@@ -44,18 +48,61 @@ namespace wlib::SPI
     [[nodiscard]] constexpr Mode     get_mode() const { return this->m_mode; }
     [[nodiscard]] constexpr Bitorder get_bitorder() const { return this->m_bitorder; }
 
+    [[nodiscard]] constexpr bool operator==(SPI_configuration_t const&) const = default;
+
   private:
     uint32_t m_baudrate;
     Mode     m_mode;
     Bitorder m_bitorder;
   };
 
+  // one piece of the transmitted stream, a segment without data clocks out size dummy bytes
+  struct tx_segment_t
+  {
+    constexpr tx_segment_t(std::span<std::byte const> buffer) noexcept
+        : data{ buffer.data() }
+        , size{ buffer.size() }
+    {
+    }
+    constexpr explicit tx_segment_t(std::size_t number_of_dummy_bytes) noexcept
+        : data{ nullptr }
+        , size{ number_of_dummy_bytes }
+    {
+    }
+
+    std::byte const* data;
+    std::size_t      size;
+  };
+
+  // one piece of the received stream, a segment without data discards size bytes
+  struct rx_segment_t
+  {
+    constexpr rx_segment_t(std::span<std::byte> buffer) noexcept
+        : data{ buffer.data() }
+        , size{ buffer.size() }
+    {
+    }
+    constexpr explicit rx_segment_t(std::size_t number_of_discarded_bytes) noexcept
+        : data{ nullptr }
+        , size{ number_of_discarded_bytes }
+    {
+    }
+
+    std::byte*  data;
+    std::size_t size;
+  };
+
   class Connection_Interface
   {
   public:
     virtual ~Connection_Interface() = default;
 
     virtual void transcieve(std::byte const* tx, std::byte* rx, std::size_t const& len) = 0;
+
+    // clocks the concatenated tx segments while the concatenated rx segments are received, the shorter stream is
+    // padded with dummy or discarded bytes. the default splits the segments into transcieve() calls without copying,
+    // hardware with native scatter/gather overrides it
+    virtual void transcieve(std::span<tx_segment_t const> tx, std::span<rx_segment_t const> rx);
   };
 
   class Hardware_Interface: protected Connection_Interface
@@ -78,6 +125,8 @@ namespace wlib::SPI
     friend Hardware_handle_t;
     friend Channel_handle_t;
     friend Connection_handle_t;
+    friend Transaction_Queue;
+    friend Bus_Arbiter;
   };
 
   class Chipselect_Interface
@@ -97,6 +146,7 @@ namespace wlib::SPI
     friend Hardware_handle_t;
     friend Channel_handle_t;
     friend Connection_handle_t;
+    friend Transaction_Queue;
   };
 
   class Connection_handle_t: public Connection_Interface
@@ -110,6 +160,7 @@ namespace wlib::SPI
     ~Connection_handle_t();
 
     void transcieve(std::byte const* tx, std::byte* rx, std::size_t const& len) override;
+    void transcieve(std::span<tx_segment_t const> tx, std::span<rx_segment_t const> rx) override;
 
   private:
     Hardware_Interface*   m_hw;
@@ -150,9 +201,12 @@ namespace wlib::SPI
     [[nodiscard]] Connection_handle_t select(Chipselect_Interface& cs) &&;
 
   private:
+    // serializes the connections selected from one handle, a second select() waits until the first connection is gone
     class single_use_hardware_lock_t final: public Hardware_Interface
     {
     public:
+      using Connection_Interface::transcieve;
+
       void enable(SPI_configuration_t const&) override;
       void disable() override;
       void transcieve(std::byte const*, std::byte*, std::size_t const&) override;
@@ -160,7 +214,7 @@ namespace wlib::SPI
       void lock_hw();
 
     private:
-      bool m_is_locked = false;
+      std::atomic<bool> m_is_locked = false;
     };
 
     Hardware_Interface*        m_hw;
@@ -0,0 +1,162 @@
+#pragma once
+#ifndef WLIB_SPI_SIMULATION_HPP_INCLUDED
+#define WLIB_SPI_SIMULATION_HPP_INCLUDED
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <wlib-SPI_Interface.hpp>
+
+namespace wlib::SPI
+{
+  class Simulated_Bus;
+  class Simulated_Chipselect;
+
+  // all simulated time is virtual, it only advances with clocked bytes, the modelled overheads and advance(). runs are
+  // therefore reproducible and independent of the host
+  using simulated_time_t = std::chrono::nanoseconds;
+
+  struct bus_timing_t
+  {
+    simulated_time_t enable   = simulated_time_t{ 0 };    // reconfiguration of the controller
+    simulated_time_t select   = simulated_time_t{ 0 };    // chip select setup and hold
+    simulated_time_t transfer = simulated_time_t{ 0 };    // setup of one transcieve call, e.g. a driver call or a dma start
+  };
+
+  class Simulated_Device_Interface
+  {
+  public:
+    Simulated_Device_Interface()                                             = default;
+    Simulated_Device_Interface(Simulated_Device_Interface const&)            = delete;
+    Simulated_Device_Interface(Simulated_Device_Interface&&)                 = delete;
+    Simulated_Device_Interface& operator=(Simulated_Device_Interface const&) = delete;
+    Simulated_Device_Interface& operator=(Simulated_Device_Interface&&)      = delete;
+    virtual ~Simulated_Device_Interface()                                    = default;
+
+  protected:
+    virtual void      begin(simulated_time_t now)                   = 0;
+    virtual std::byte exchange(std::byte mosi, simulated_time_t now) = 0;
+    virtual void      end(simulated_time_t now)                     = 0;
+
+    friend Simulated_Bus;
+    friend Simulated_Chipselect;
+  };
+
+  // controller model, every byte takes 8 clocks of the configured baudrate. without a selected device miso reads 0xFF
+  class Simulated_Bus final: public Hardware_Interface
+  {
+  public:
+    explicit Simulated_Bus(bus_timing_t const& timing = {}) noexcept
+        : m_timing{ timing }
+    {
+    }
+
+    void advance(simulated_time_t duration) noexcept { this->m_now += duration; }
+    void reset_statistics() noexcept;
+
+    simulated_time_t get_time() const noexcept { return this->m_now; }
+    // time spent clocking bytes, compared to get_time() it gives the bus utilisation
+    simulated_time_t get_clocked_time() const noexcept { return this->m_clocked; }
+    std::size_t      get_number_of_bytes() const noexcept { return this->m_number_of_bytes; }
+    std::size_t      get_number_of_transfers() const noexcept { return this->m_number_of_transfers; }
+    std::size_t      get_number_of_enables() const noexcept { return this->m_number_of_enables; }
+
+  private:
+    void enable(SPI_configuration_t const& cfg) override;
+    void disable() override;
+    void transcieve(std::byte const* tx, std::byte* rx, std::size_t const& len) override;
+    // one transfer setup for all segments, like a controller with native scatter/gather
+    void transcieve(std::span<tx_segment_t const> tx, std::span<rx_segment_t const> rx) override;
+
+    friend Simulated_Chipselect;
+
+    bus_timing_t                m_timing;
+    simulated_time_t            m_now                 = simulated_time_t{ 0 };
+    simulated_time_t            m_clocked             = simulated_time_t{ 0 };
+    simulated_time_t            m_byte_time           = simulated_time_t{ 0 };
+    Simulated_Device_Interface* m_selected            = nullptr;
+    bool                        m_is_enabled          = false;
+    bool                        m_is_in_segments      = false;
+    std::size_t                 m_number_of_bytes     = 0;
+    std::size_t                 m_number_of_transfers = 0;
+    std::size_t                 m_number_of_enables   = 0;
+  };
+
+  class Simulated_Chipselect final: public Chipselect_Interface
+  {
+  public:
+    Simulated_Chipselect(Simulated_Bus& bus, Simulated_Device_Interface& device) noexcept
+        : m_bus{ bus }
+        , m_device{ device }
+    {
+    }
+
+  private:
+    void select() override;
+    void deselect() override;
+
+    Simulated_Bus&              m_bus;
+    Simulated_Device_Interface& m_device;
+  };
+
+  // answers every byte with the byte received at the same time
+  class Loopback_Device final: public Simulated_Device_Interface
+  {
+  private:
+    void      begin(simulated_time_t) override {}
+    std::byte exchange(std::byte mosi, simulated_time_t) override { return mosi; }
+    void      end(simulated_time_t) override {}
+  };
+
+  struct nor_flash_timing_t
+  {
+    simulated_time_t page_program = std::chrono::microseconds{ 700 };
+    simulated_time_t sector_erase = std::chrono::milliseconds{ 45 };
+    simulated_time_t block_erase  = std::chrono::milliseconds{ 150 };
+    simulated_time_t chip_erase   = std::chrono::milliseconds{ 10000 };
+  };
+
+  // jedec serial nor flash with 3 byte addresses, 256 byte pages, 4k sectors and 64k blocks. supports read id (9F),
+  // read status (05), write enable / disable (06 / 04), read (03), fast read (0B), page program (02), sector erase (20),
+  // block erase (D8) and chip erase (C7 / 60). like a real chip it ignores everything but read status while busy and
+  // programming only clears bits. the storage is owned by the caller, an erased chip is all 0xFF
+  class Simulated_Nor_Flash final: public Simulated_Device_Interface
+  {
+  public:
+    static constexpr std::size_t page_size   = 256;
+    static constexpr std::size_t sector_size = 4096;
+    static constexpr std::size_t block_size  = 65536;
+
+    using jedec_id_t = std::array<std::byte, 3>;
+
+    explicit Simulated_Nor_Flash(std::span<std::byte> storage, nor_flash_timing_t const& timing = {}, jedec_id_t const& id = { std::byte{ 0xEF }, std::byte{ 0x40 }, std::byte{ 0x18 } });
+
+    std::size_t get_number_of_programs() const noexcept { return this->m_number_of_programs; }
+    std::size_t get_number_of_erases() const noexcept { return this->m_number_of_erases; }
+
+  private:
+    void      begin(simulated_time_t now) override;
+    std::byte exchange(std::byte mosi, simulated_time_t now) override;
+    void      end(simulated_time_t now) override;
+
+    std::byte p_status(simulated_time_t now) const noexcept;
+    void      p_erase(std::size_t add, std::size_t size, simulated_time_t now, simulated_time_t duration);
+
+    std::span<std::byte>   m_storage;
+    nor_flash_timing_t     m_timing;
+    jedec_id_t             m_id;
+    simulated_time_t       m_busy_until         = simulated_time_t{ 0 };
+    bool                   m_is_write_enabled   = false;
+    std::uint8_t           m_cmd                = 0;
+    std::size_t            m_pos                = 0;
+    std::size_t            m_add                = 0;
+    std::vector<std::byte> m_page               = {};
+    std::size_t            m_number_of_programs = 0;
+    std::size_t            m_number_of_erases   = 0;
+  };
+}    // namespace wlib::SPI
+
+#endif
@@ -0,0 +1,81 @@
+#pragma once
+#ifndef WLIB_SPI_SPIDEV_HPP_INCLUDED
+#define WLIB_SPI_SPIDEV_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+#include <wlib-SPI_Interface.hpp>
+
+#if __has_include(<linux/spi/spidev.h>)
+
+namespace wlib::SPI
+{
+  // linux userspace spi device, e.g. /dev/spidev0.0. a segment transfer is sent as one SPI_IOC_MESSAGE with one
+  // spi_ioc_transfer per segment overlap, so a whole transaction costs a single syscall.
+  // with the kernel chip select the Chipselect_Interface is a native_chipselect_t of this device. between its select()
+  // and deselect() every message is sent with cs_change on its last transfer, so chip select stays asserted across
+  // transcieve() calls and across messages split at the bufsiz of the spidev module. deselect() ends the frame with an
+  // empty transfer. the kernel still drops chip select when a message for another device on the same controller comes
+  // in between. with an external chip select the device is opened in SPI_NO_CS mode and any Chipselect_Interface, e.g.
+  // a gpio, frames the transfers
+  class Spidev_Hardware final: public Hardware_Interface
+  {
+  public:
+    enum class chipselect_t : std::uint8_t
+    {
+      kernel,
+      external,
+    };
+
+    class native_chipselect_t final: public Chipselect_Interface
+    {
+    public:
+      explicit native_chipselect_t(Spidev_Hardware& hw) noexcept
+          : m_hw{ hw }
+      {
+      }
+
+    private:
+      void select() override { this->m_hw.m_is_framed = true; }
+      void deselect() override { this->m_hw.p_end_frame(); }
+
+      Spidev_Hardware& m_hw;
+    };
+
+    explicit Spidev_Hardware(char const* path, chipselect_t cs = chipselect_t::kernel);
+    ~Spidev_Hardware() override;
+
+    std::size_t get_max_message_size() const noexcept { return this->m_max_message_size; }
+    std::size_t get_number_of_messages() const noexcept { return this->m_number_of_messages; }
+
+  private:
+    struct transfer_t;
+
+    void enable(SPI_configuration_t const& cfg) override;
+    void disable() override {}
+    void transcieve(std::byte const* tx, std::byte* rx, std::size_t const& len) override;
+    void transcieve(std::span<tx_segment_t const> tx, std::span<rx_segment_t const> rx) override;
+
+    void p_append(std::byte const* tx, std::byte* rx, std::size_t len);
+    void p_submit();
+    void p_end_frame();
+
+    int                                m_fd;
+    chipselect_t                       m_cs;
+    std::size_t                        m_max_message_size   = 4096;
+    std::uint32_t                      m_speed              = 0;
+    std::optional<SPI_configuration_t> m_cfg                = std::nullopt;
+    bool                               m_is_in_segments     = false;
+    bool                               m_is_framed          = false;
+    bool                               m_is_cs_held         = false;
+    std::size_t                        m_message_size       = 0;
+    std::vector<transfer_t>            m_transfers;
+    std::size_t                        m_number_of_messages = 0;
+  };
+}    // namespace wlib::SPI
+
+#endif
+#endif
@@ -0,0 +1,115 @@
+#pragma once
+#ifndef WLIB_SPI_TRANSACTION_QUEUE_HPP_INCLUDED
+#define WLIB_SPI_TRANSACTION_QUEUE_HPP_INCLUDED
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <wlib-Callback.hpp>
+#include <wlib-SPI_Interface.hpp>
+
+namespace wlib::SPI
+{
+  class transaction_t;
+  class Transaction_Queue;
+
+  using transaction_completion_t = wlib::Callback<void(transaction_t&)>;
+
+  enum class transaction_status_t : std::uint8_t
+  {
+    idle,
+    queued,
+    done,
+    // dispatch() threw while the transaction was due, the completion does not run
+    failed,
+  };
+
+  // one chip select cycle. tx and rx are clocked full duplex, the shorter one is padded with dummy bytes or discarded
+  // bytes up to the longer one. the descriptor and its buffers are owned by the caller and have to stay alive until
+  // the transaction is done. the completion runs on the dispatching thread right after the status became done and
+  // may resubmit the descriptor. a descriptor with a completion has to outlive that call, wait() alone does not cover it
+  class transaction_t
+  {
+  public:
+    transaction_t(SPI_configuration_t const&  cfg,
+                  Chipselect_Interface&       cs,
+                  std::span<std::byte const>  tx,
+                  std::span<std::byte>        rx,
+                  transaction_completion_t*   on_complete = nullptr) noexcept
+        : m_cfg{ cfg }
+        , m_cs{ &cs }
+        , m_tx{ tx }
+        , m_rx{ rx }
+        , m_on_complete{ on_complete }
+    {
+    }
+    transaction_t(transaction_t const&)            = delete;
+    transaction_t(transaction_t&&)                 = delete;
+    transaction_t& operator=(transaction_t const&) = delete;
+    transaction_t& operator=(transaction_t&&)      = delete;
+    ~transaction_t()                               = default;
+
+    // swaps the buffers of an idle or done descriptor, e.g. for the next cycle of a polling loop
+    void set_buffers(std::span<std::byte const> tx, std::span<std::byte> rx);
+
+    transaction_status_t get_status() const noexcept { return this->m_status.load(std::memory_order_acquire); }
+    bool                 is_pending() const noexcept { return this->get_status() == transaction_status_t::queued; }
+
+    // blocks until the queue ran the transaction or it failed
+    void wait() const noexcept;
+
+  private:
+    friend Transaction_Queue;
+
+    SPI_configuration_t               m_cfg;
+    Chipselect_Interface*             m_cs;
+    std::span<std::byte const>        m_tx;
+    std::span<std::byte>              m_rx;
+    transaction_completion_t*         m_on_complete;
+    std::atomic<transaction_status_t> m_status = transaction_status_t::idle;
+    transaction_t*                    m_next   = nullptr;
+  };
+
+  // any thread may submit, dispatch() runs the queued transactions in submission order back to back. consecutive
+  // transactions with an equal configuration share one enable()/disable() cycle of the hardware. the hardware must not
+  // be used through handles while dispatch() runs
+  class Transaction_Queue
+  {
+  public:
+    explicit Transaction_Queue(Hardware_Interface& hw) noexcept
+        : m_hw{ hw }
+    {
+    }
+    Transaction_Queue(Transaction_Queue const&)            = delete;
+    Transaction_Queue(Transaction_Queue&&)                 = delete;
+    Transaction_Queue& operator=(Transaction_Queue const&) = delete;
+    Transaction_Queue& operator=(Transaction_Queue&&)      = delete;
+    ~Transaction_Queue()                                   = default;
+
+    void submit(transaction_t& trans);
+    // queues the whole batch with a single atomic operation, the transactions keep their order
+    void submit(std::span<transaction_t> batch);
+
+    // runs queued transactions until the queue is empty, returns their number. only one thread may dispatch at a time.
+    // exceptions of the hardware or a chip select propagate after the chip select is deselected and the hardware
+    // disabled, the transactions dispatch() had already taken off the queue are failed, the rest stays queued
+    std::size_t dispatch();
+    // blocks until at least one transaction is queued
+    void        wait_for_submission() const noexcept;
+
+    bool        is_empty() const noexcept { return this->m_head.load(std::memory_order_acquire) == nullptr; }
+    std::size_t get_number_of_reconfigurations() const noexcept { return this->m_number_of_reconfigurations; }
+
+  private:
+    void p_push(transaction_t& first, transaction_t& last);
+    void p_run(transaction_t& trans);
+    static void p_fail(transaction_t& trans) noexcept;
+
+    Hardware_Interface&         m_hw;
+    std::atomic<transaction_t*> m_head                       = nullptr;
+    std::size_t                 m_number_of_reconfigurations = 0;
+  };
+}    // namespace wlib::SPI
+
+#endif
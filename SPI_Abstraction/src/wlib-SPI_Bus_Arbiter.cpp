@@ -0,0 +1,119 @@
+#include <wlib-SPI_Bus_Arbiter.hpp>
+
+namespace wlib::SPI
+{
+  void Bus_Arbiter::port_t::enable(SPI_configuration_t const& cfg)
+  {
+    this->m_arbiter.p_acquire(this->m_priority);
+    try
+    {
+      this->m_arbiter.p_configure(cfg);
+    }
+    catch (...)
+    {
+      // no handle is built on a failed enable(), so disable() would never hand the bus on
+      this->m_arbiter.p_release();
+      throw;
+    }
+  }
+  void Bus_Arbiter::port_t::disable() { this->m_arbiter.p_release(); }
+  void Bus_Arbiter::port_t::transcieve(std::byte const* tx, std::byte* rx, std::size_t const& len) { return this->m_arbiter.m_hw.transcieve(tx, rx, len); }
+  void Bus_Arbiter::port_t::transcieve(std::span<tx_segment_t const> tx, std::span<rx_segment_t const> rx) { return this->m_arbiter.m_hw.transcieve(tx, rx); }
+
+  Bus_Arbiter::~Bus_Arbiter()
+  {
+    if (this->m_active.has_value())
+      this->m_hw.disable();
+  }
+
+  void Bus_Arbiter::power_down()
+  {
+    this->p_acquire(bus_priority_t::realtime);
+    if (this->m_active.has_value())
+    {
+      this->m_hw.disable();
+      this->m_active = std::nullopt;
+    }
+    this->p_release();
+  }
+
+  void Bus_Arbiter::p_acquire(bus_priority_t priority)
+  {
+    std::uint32_t state = 0;
+    if (this->m_state.compare_exchange_strong(state, owned, std::memory_order_acquire, std::memory_order_relaxed))
+      return;
+
+    // a free bus is only taken here if nobody waits, otherwise the caller queues up behind the waiters
+    std::size_t const prio = static_cast<std::size_t>(priority);
+    std::uint64_t     mine = 0;
+    this->p_lock();
+    while (true)
+    {
+      if (state == 0)
+      {
+        if (this->m_state.compare_exchange_weak(state, owned, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+          this->p_unlock();
+          return;
+        }
+        continue;
+      }
+
+      if (this->m_state.compare_exchange_weak(state, state + waiter, std::memory_order_relaxed))
+        break;
+    }
+    mine = std::uint64_t{ prio } << 32 | this->m_next_ticket[prio]++;
+    this->p_unlock();
+    this->m_number_of_contentions.fetch_add(1, std::memory_order_relaxed);
+
+    for (std::uint64_t grant = this->m_grant.load(std::memory_order_acquire); grant != mine; grant = this->m_grant.load(std::memory_order_acquire))
+      this->m_grant.wait(grant, std::memory_order_acquire);
+  }
+
+  void Bus_Arbiter::p_release()
+  {
+    std::uint32_t state = owned;
+    if (this->m_state.compare_exchange_strong(state, 0, std::memory_order_release, std::memory_order_relaxed))
+      return;
+
+    // waiters only register under the lock, so one of them is found and the bus is handed over without being freed
+    this->p_lock();
+    std::size_t prio = number_of_priorities;
+    while (prio > 0 && this->m_serving[prio - 1] == this->m_next_ticket[prio - 1])
+      --prio;
+
+    std::uint64_t const grant = std::uint64_t{ prio - 1 } << 32 | this->m_serving[prio - 1]++;
+    this->m_state.fetch_sub(waiter, std::memory_order_relaxed);
+    this->m_grant.store(grant, std::memory_order_release);
+    this->p_unlock();
+    this->m_grant.notify_all();
+  }
+
+  void Bus_Arbiter::p_configure(SPI_configuration_t const& cfg)
+  {
+    if (this->m_active == cfg)
+      return;
+
+    // a failed enable() leaves no active configuration behind, the next owner enables again
+    if (this->m_active.has_value())
+    {
+      this->m_hw.disable();
+      this->m_active = std::nullopt;
+    }
+    this->m_hw.enable(cfg);
+    this->m_active = cfg;
+    this->m_number_of_reconfigurations.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void Bus_Arbiter::p_lock() noexcept
+  {
+    while (this->m_lock.test_and_set(std::memory_order_acquire))
+      this->m_lock.wait(true, std::memory_order_relaxed);
+  }
+
+  void Bus_Arbiter::p_unlock() noexcept
+  {
+    this->m_lock.clear(std::memory_order_release);
+    this->m_lock.notify_one();
+  }
+}    // namespace wlib::SPI
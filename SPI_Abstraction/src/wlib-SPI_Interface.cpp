@@ -1,7 +1,5 @@
 #include <wlib-SPI_Interface.hpp>
 
-void throw_multible_active_con_error();
-
 namespace wlib::SPI
 {
   namespace
@@ -9,6 +7,8 @@ namespace wlib::SPI
     class hw_dummy final: public Hardware_Interface
     {
     public:
+      using Connection_Interface::transcieve;
+
       virtual void transcieve(std::byte const*, std::byte*, std::size_t const&) override {}
       virtual void enable(const SPI_configuration_t&) override {}
       virtual void disable() override {}
@@ -18,6 +18,41 @@ namespace wlib::SPI
 
   Hardware_Interface& Hardware_Interface::get_dummy() { return hw_dummy_obj; }
 
+  void Connection_Interface::transcieve(std::span<tx_segment_t const> tx, std::span<rx_segment_t const> rx)
+  {
+    std::size_t tx_idx = 0;
+    std::size_t tx_off = 0;
+    std::size_t rx_idx = 0;
+    std::size_t rx_off = 0;
+    while (true)
+    {
+      for (; tx_idx < tx.size() && tx_off == tx[tx_idx].size; tx_off = 0)
+        ++tx_idx;
+      for (; rx_idx < rx.size() && rx_off == rx[rx_idx].size; rx_off = 0)
+        ++rx_idx;
+
+      bool const has_tx = tx_idx < tx.size();
+      bool const has_rx = rx_idx < rx.size();
+      if (!has_tx && !has_rx)
+        return;
+
+      std::size_t len = SIZE_MAX;
+      if (has_tx)
+        len = tx[tx_idx].size - tx_off;
+      if (has_rx && rx[rx_idx].size - rx_off < len)
+        len = rx[rx_idx].size - rx_off;
+
+      std::byte const* const tx_ptr = has_tx && tx[tx_idx].data != nullptr ? tx[tx_idx].data + tx_off : nullptr;
+      std::byte* const       rx_ptr = has_rx && rx[rx_idx].data != nullptr ? rx[rx_idx].data + rx_off : nullptr;
+      this->transcieve(tx_ptr, rx_ptr, len);
+
+      if (has_tx)
+        tx_off += len;
+      if (has_rx)
+        rx_off += len;
+    }
+  }
+
   Connection_handle_t::Connection_handle_t(Hardware_Interface& hw, Chipselect_Interface& cs, Connection_Interface& con)
       : m_hw(&hw)
       , m_cs(&cs)
@@ -31,6 +66,7 @@ namespace wlib::SPI
     this->m_hw->disable();
   }
   void Connection_handle_t::transcieve(std::byte const* tx, std::byte* rx, std::size_t const& len) { return this->m_con->transcieve(tx, rx, len); }
+  void Connection_handle_t::transcieve(std::span<tx_segment_t const> tx, std::span<rx_segment_t const> rx) { return this->m_con->transcieve(tx, rx); }
 
   Channel_handle_t::Channel_handle_t(Hardware_Interface& hw, Chipselect_Interface& cs, SPI_configuration_t const& cfg)
       : m_hw(&hw)
@@ -71,21 +107,17 @@ namespace wlib::SPI
   }
 
   void Hardware_handle_t::single_use_hardware_lock_t::enable(SPI_configuration_t const&) {};
-  void Hardware_handle_t::single_use_hardware_lock_t::disable() { this->m_is_locked = false; };
+  void Hardware_handle_t::single_use_hardware_lock_t::disable()
+  {
+    this->m_is_locked.store(false, std::memory_order_release);
+    this->m_is_locked.notify_one();
+  };
   void Hardware_handle_t::single_use_hardware_lock_t::transcieve(std::byte const*, std::byte*, std::size_t const&) {}
 
   void Hardware_handle_t::single_use_hardware_lock_t::lock_hw()
   {
-    if (this->m_is_locked)
-      throw_multible_active_con_error();
-
-    this->m_is_locked = true;
+    while (this->m_is_locked.exchange(true, std::memory_order_acquire))
+      this->m_is_locked.wait(true, std::memory_order_relaxed);
   }
 
 }    // namespace wlib::SPI
-
-void throw_multible_active_con_error()
-{
-  while (true)
-    ;
-}
@@ -0,0 +1,250 @@
+#include <wlib-SPI_Simulation.hpp>
+
+//
+#include <algorithm>
+#include <stdexcept>
+
+namespace wlib::SPI
+{
+  namespace
+  {
+    void handle_bus_state_exception(char const* what) { throw std::logic_error(what); }
+    void handle_configuration_exception() { throw std::invalid_argument("flash storage is not a multiple of the sector size"); }
+
+    enum flash_cmd_t : std::uint8_t
+    {
+      cmd_none          = 0x00,
+      cmd_page_program  = 0x02,
+      cmd_read          = 0x03,
+      cmd_write_disable = 0x04,
+      cmd_read_status   = 0x05,
+      cmd_write_enable  = 0x06,
+      cmd_fast_read     = 0x0B,
+      cmd_sector_erase  = 0x20,
+      cmd_chip_erase_60 = 0x60,
+      cmd_read_id       = 0x9F,
+      cmd_chip_erase_c7 = 0xC7,
+      cmd_block_erase   = 0xD8,
+    };
+
+    constexpr std::byte status_busy          = std::byte{ 0x01 };
+    constexpr std::byte status_write_enabled = std::byte{ 0x02 };
+    constexpr std::size_t address_bytes      = 3;
+  }    // namespace
+
+  void Simulated_Bus::reset_statistics() noexcept
+  {
+    this->m_clocked             = simulated_time_t{ 0 };
+    this->m_now                 = simulated_time_t{ 0 };
+    this->m_number_of_bytes     = 0;
+    this->m_number_of_transfers = 0;
+    this->m_number_of_enables   = 0;
+  }
+
+  void Simulated_Bus::enable(SPI_configuration_t const& cfg)
+  {
+    if (this->m_is_enabled)
+      handle_bus_state_exception("simulated bus is already enabled");
+
+    // 8 clocks per byte, rounded up to whole nanoseconds
+    std::uint64_t const baudrate = std::max<std::uint64_t>(cfg.get_baudrate(), 1);
+    this->m_byte_time            = simulated_time_t{ (8'000'000'000ull + baudrate - 1) / baudrate };
+    this->m_is_enabled           = true;
+    this->m_now += this->m_timing.enable;
+    ++this->m_number_of_enables;
+  }
+
+  void Simulated_Bus::disable() { this->m_is_enabled = false; }
+
+  void Simulated_Bus::transcieve(std::byte const* tx, std::byte* rx, std::size_t const& len)
+  {
+    if (!this->m_is_enabled)
+      handle_bus_state_exception("simulated bus is not enabled");
+
+    if (!this->m_is_in_segments)
+    {
+      this->m_now += this->m_timing.transfer;
+      ++this->m_number_of_transfers;
+    }
+
+    for (std::size_t i = 0; i < len; ++i)
+    {
+      this->m_now += this->m_byte_time;
+      this->m_clocked += this->m_byte_time;
+
+      std::byte const mosi = tx != nullptr ? tx[i] : std::byte{ 0x00 };
+      std::byte const miso = this->m_selected != nullptr ? this->m_selected->exchange(mosi, this->m_now) : std::byte{ 0xFF };
+      if (rx != nullptr)
+        rx[i] = miso;
+    }
+    this->m_number_of_bytes += len;
+  }
+
+  void Simulated_Bus::transcieve(std::span<tx_segment_t const> tx, std::span<rx_segment_t const> rx)
+  {
+    this->m_now += this->m_timing.transfer;
+    ++this->m_number_of_transfers;
+
+    this->m_is_in_segments = true;
+    Connection_Interface::transcieve(tx, rx);
+    this->m_is_in_segments = false;
+  }
+
+  void Simulated_Chipselect::select()
+  {
+    if (this->m_bus.m_selected != nullptr)
+      handle_bus_state_exception("another simulated device is selected");
+
+    this->m_bus.m_now += this->m_bus.m_timing.select;
+    this->m_bus.m_selected = &this->m_device;
+    this->m_device.begin(this->m_bus.m_now);
+  }
+
+  void Simulated_Chipselect::deselect()
+  {
+    this->m_device.end(this->m_bus.m_now);
+    this->m_bus.m_selected = nullptr;
+  }
+
+  Simulated_Nor_Flash::Simulated_Nor_Flash(std::span<std::byte> storage, nor_flash_timing_t const& timing, jedec_id_t const& id)
+      : m_storage{ storage }
+      , m_timing{ timing }
+      , m_id{ id }
+      , m_page(page_size)
+  {
+    if (storage.empty() || storage.size() % sector_size != 0)
+      handle_configuration_exception();
+  }
+
+  void Simulated_Nor_Flash::begin(simulated_time_t)
+  {
+    this->m_cmd = cmd_none;
+    this->m_pos = 0;
+    this->m_add = 0;
+  }
+
+  std::byte Simulated_Nor_Flash::exchange(std::byte mosi, simulated_time_t now)
+  {
+    std::size_t const pos = this->m_pos++;
+    if (pos == 0)
+    {
+      this->m_cmd = std::to_integer<std::uint8_t>(mosi);
+      if (now < this->m_busy_until && this->m_cmd != cmd_read_status)
+        this->m_cmd = cmd_none;
+      if (this->m_cmd == cmd_page_program)
+        std::fill(this->m_page.begin(), this->m_page.end(), std::byte{ 0xFF });
+      return std::byte{ 0xFF };
+    }
+
+    switch (this->m_cmd)
+    {
+    case cmd_read_status:
+      return this->p_status(now);
+
+    case cmd_read_id:
+      return pos - 1 < this->m_id.size() ? this->m_id[pos - 1] : std::byte{ 0xFF };
+
+    case cmd_read:
+    case cmd_fast_read:
+    case cmd_page_program:
+    case cmd_sector_erase:
+    case cmd_block_erase:
+      if (pos <= address_bytes)
+      {
+        this->m_add = (this->m_add << 8 | std::to_integer<std::size_t>(mosi)) % this->m_storage.size();
+        return std::byte{ 0xFF };
+      }
+      break;
+
+    default:
+      return std::byte{ 0xFF };
+    }
+
+    std::size_t const data_pos = pos - address_bytes - 1;
+    switch (this->m_cmd)
+    {
+    case cmd_read:
+      return this->m_storage[(this->m_add + data_pos) % this->m_storage.size()];
+
+    case cmd_fast_read:
+      // one dummy byte follows the address
+      if (data_pos == 0)
+        return std::byte{ 0xFF };
+      return this->m_storage[(this->m_add + data_pos - 1) % this->m_storage.size()];
+
+    case cmd_page_program:
+      // data wraps around within the addressed page
+      this->m_page[(this->m_add + data_pos) % page_size] = mosi;
+      return std::byte{ 0xFF };
+
+    default:
+      return std::byte{ 0xFF };
+    }
+  }
+
+  void Simulated_Nor_Flash::end(simulated_time_t now)
+  {
+    bool const is_addressed = this->m_pos > address_bytes;
+    switch (this->m_cmd)
+    {
+    case cmd_write_enable:
+      this->m_is_write_enabled = true;
+      break;
+
+    case cmd_write_disable:
+      this->m_is_write_enabled = false;
+      break;
+
+    case cmd_page_program:
+      if (!this->m_is_write_enabled || this->m_pos <= address_bytes + 1)
+        break;
+      {
+        std::size_t const page_add = this->m_add - this->m_add % page_size;
+        for (std::size_t i = 0; i < page_size; ++i)
+          this->m_storage[page_add + i] &= this->m_page[i];
+      }
+      this->m_is_write_enabled = false;
+      this->m_busy_until       = now + this->m_timing.page_program;
+      ++this->m_number_of_programs;
+      break;
+
+    case cmd_sector_erase:
+      if (this->m_is_write_enabled && is_addressed)
+        this->p_erase(this->m_add - this->m_add % sector_size, sector_size, now, this->m_timing.sector_erase);
+      break;
+
+    case cmd_block_erase:
+      if (this->m_is_write_enabled && is_addressed)
+        this->p_erase(this->m_add - this->m_add % block_size, block_size, now, this->m_timing.block_erase);
+      break;
+
+    case cmd_chip_erase_60:
+    case cmd_chip_erase_c7:
+      if (this->m_is_write_enabled)
+        this->p_erase(0, this->m_storage.size(), now, this->m_timing.chip_erase);
+      break;
+
+    default:
+      break;
+    }
+    this->m_cmd = cmd_none;
+  }
+
+  std::byte Simulated_Nor_Flash::p_status(simulated_time_t now) const noexcept
+  {
+    std::byte ret = std::byte{ 0x00 };
+    if (now < this->m_busy_until)
+      ret |= status_busy;
+    if (this->m_is_write_enabled)
+      ret |= status_write_enabled;
+    return ret;
+  }
+
+  void Simulated_Nor_Flash::p_erase(std::size_t add, std::size_t size, simulated_time_t now, simulated_time_t duration)
+  {
+    std::fill_n(this->m_storage.begin() + static_cast<std::ptrdiff_t>(add), std::min(size, this->m_storage.size() - add), std::byte{ 0xFF });
+    this->m_is_write_enabled = false;
+    this->m_busy_until       = now + duration;
+    ++this->m_number_of_erases;
+  }
+}    // namespace wlib::SPI
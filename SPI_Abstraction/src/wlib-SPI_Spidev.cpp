@@ -0,0 +1,170 @@
+#include <wlib-SPI_Spidev.hpp>
+
+#if __has_include(<linux/spi/spidev.h>)
+
+//
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <linux/spi/spidev.h>
+#include <sys/ioctl.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace wlib::SPI
+{
+  namespace
+  {
+    void handle_system_exception(char const* what) { throw std::system_error(errno, std::generic_category(), what); }
+
+    // SPI_IOC_MESSAGE(n) with a runtime n, the size field of the request limits one message to 511 transfers
+    constexpr std::size_t max_transfers = ((1u << _IOC_SIZEBITS) - 1) / sizeof(spi_ioc_transfer);
+
+    unsigned long message_request(std::size_t number_of_transfers) { return _IOC(_IOC_WRITE, SPI_IOC_MAGIC, 0, number_of_transfers * sizeof(spi_ioc_transfer)); }
+
+    std::size_t read_bufsiz(std::size_t fallback)
+    {
+      std::FILE* const file = std::fopen("/sys/module/spidev/parameters/bufsiz", "r");
+      if (file == nullptr)
+        return fallback;
+
+      unsigned long value = 0;
+      bool const    is_ok = std::fscanf(file, "%lu", &value) == 1 && value > 0;
+      std::fclose(file);
+      return is_ok ? value : fallback;
+    }
+  }    // namespace
+
+  struct Spidev_Hardware::transfer_t: spi_ioc_transfer
+  {
+  };
+
+  Spidev_Hardware::Spidev_Hardware(char const* path, chipselect_t cs)
+      : m_fd{ ::open(path, O_RDWR | O_CLOEXEC) }
+      , m_cs{ cs }
+  {
+    if (this->m_fd < 0)
+      handle_system_exception("unable to open spidev device");
+
+    this->m_max_message_size = read_bufsiz(this->m_max_message_size);
+    this->m_transfers.reserve(16);
+  }
+
+  Spidev_Hardware::~Spidev_Hardware() { ::close(this->m_fd); }
+
+  void Spidev_Hardware::enable(SPI_configuration_t const& cfg)
+  {
+    // the device keeps its settings between users, only a different configuration costs syscalls
+    if (this->m_cfg == cfg)
+      return;
+
+    std::uint8_t mode = static_cast<std::uint8_t>(cfg.get_mode());
+    if (cfg.get_bitorder() == SPI_configuration_t::Bitorder::LSB_first)
+      mode |= SPI_LSB_FIRST;
+    if (this->m_cs == chipselect_t::external)
+      mode |= SPI_NO_CS;
+
+    std::uint8_t  bits  = 8;
+    std::uint32_t speed = cfg.get_baudrate();
+    if (::ioctl(this->m_fd, SPI_IOC_WR_MODE, &mode) < 0 || ::ioctl(this->m_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 || ::ioctl(this->m_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0)
+    {
+      this->m_cfg = std::nullopt;
+      handle_system_exception("unable to configure spidev device");
+    }
+
+    this->m_speed = speed;
+    this->m_cfg   = cfg;
+  }
+
+  void Spidev_Hardware::transcieve(std::byte const* tx, std::byte* rx, std::size_t const& len)
+  {
+    this->p_append(tx, rx, len);
+    if (!this->m_is_in_segments)
+      this->p_submit();
+  }
+
+  void Spidev_Hardware::transcieve(std::span<tx_segment_t const> tx, std::span<rx_segment_t const> rx)
+  {
+    this->m_is_in_segments = true;
+    try
+    {
+      Connection_Interface::transcieve(tx, rx);
+    }
+    catch (...)
+    {
+      this->m_is_in_segments = false;
+      this->m_transfers.clear();
+      this->m_message_size = 0;
+      throw;
+    }
+    this->m_is_in_segments = false;
+    this->p_submit();
+  }
+
+  void Spidev_Hardware::p_append(std::byte const* tx, std::byte* rx, std::size_t len)
+  {
+    while (len > 0)
+    {
+      if (this->m_message_size == this->m_max_message_size || this->m_transfers.size() == max_transfers)
+        this->p_submit();
+
+      std::size_t const chunk = std::min(len, this->m_max_message_size - this->m_message_size);
+
+      transfer_t& transfer   = this->m_transfers.emplace_back();
+      transfer.tx_buf        = reinterpret_cast<std::uintptr_t>(tx);
+      transfer.rx_buf        = reinterpret_cast<std::uintptr_t>(rx);
+      transfer.len           = static_cast<std::uint32_t>(chunk);
+      transfer.speed_hz      = this->m_speed;
+      transfer.bits_per_word = 8;
+
+      this->m_message_size += chunk;
+      len -= chunk;
+      if (tx != nullptr)
+        tx += chunk;
+      if (rx != nullptr)
+        rx += chunk;
+    }
+  }
+
+  void Spidev_Hardware::p_submit()
+  {
+    if (this->m_transfers.empty())
+      return;
+
+    // keeps chip select asserted until the next message of the frame
+    if (this->m_is_framed && this->m_cs == chipselect_t::kernel)
+    {
+      this->m_transfers.back().cs_change = 1;
+      this->m_is_cs_held                 = true;
+    }
+
+    int const ret = ::ioctl(this->m_fd, message_request(this->m_transfers.size()), this->m_transfers.data());
+    this->m_transfers.clear();
+    this->m_message_size = 0;
+    ++this->m_number_of_messages;
+    if (ret < 0)
+      handle_system_exception("spidev transfer failed");
+  }
+
+  void Spidev_Hardware::p_end_frame()
+  {
+    this->m_is_framed = false;
+    if (!this->m_is_cs_held)
+      return;
+
+    // a message without cs_change on its last transfer releases chip select, an empty one clocks nothing. runs in the
+    // destructor of the connection, if it fails the next message releases chip select instead
+    this->m_is_cs_held = false;
+    this->m_transfers.emplace_back();
+    try
+    {
+      this->p_submit();
+    }
+    catch (std::system_error const&)
+    {
+    }
+  }
+}    // namespace wlib::SPI
+
+#endif
@@ -0,0 +1,165 @@
+#include <wlib-SPI_Transaction_Queue.hpp>
+
+//
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace wlib::SPI
+{
+  namespace
+  {
+    void handle_pending_transaction_exception() { throw std::logic_error("spi transaction is still pending"); }
+  }    // namespace
+
+  void transaction_t::set_buffers(std::span<std::byte const> tx, std::span<std::byte> rx)
+  {
+    if (this->is_pending())
+      handle_pending_transaction_exception();
+
+    this->m_tx = tx;
+    this->m_rx = rx;
+  }
+
+  void transaction_t::wait() const noexcept
+  {
+    for (transaction_status_t status = this->get_status(); status == transaction_status_t::queued; status = this->get_status())
+      this->m_status.wait(status, std::memory_order_acquire);
+  }
+
+  void Transaction_Queue::submit(transaction_t& trans) { return this->submit(std::span<transaction_t>{ &trans, 1 }); }
+
+  void Transaction_Queue::submit(std::span<transaction_t> batch)
+  {
+    if (batch.empty())
+      return;
+
+    // the whole batch is checked before any element is touched, a rejected batch leaves every descriptor as it was
+    for (transaction_t const& trans : batch)
+    {
+      if (trans.is_pending())
+        handle_pending_transaction_exception();
+    }
+
+    // the queue is a stack, every element links to the one submitted before it
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+      batch[i].m_next = i == 0 ? nullptr : &batch[i - 1];
+      batch[i].m_status.store(transaction_status_t::queued, std::memory_order_relaxed);
+    }
+    this->p_push(batch.back(), batch.front());
+  }
+
+  std::size_t Transaction_Queue::dispatch()
+  {
+    std::size_t                        ret    = 0;
+    std::optional<SPI_configuration_t> active = std::nullopt;
+    transaction_t*                     first  = nullptr;
+
+    try
+    {
+      while (transaction_t* stack = this->m_head.exchange(nullptr, std::memory_order_acquire))
+      {
+        while (stack != nullptr)
+        {
+          transaction_t* const next = stack->m_next;
+          stack->m_next             = first;
+          first                     = stack;
+          stack                     = next;
+        }
+
+        while (first != nullptr)
+        {
+          transaction_t& trans = *first;
+          if (!active.has_value() || *active != trans.m_cfg)
+          {
+            // reset first, hardware that failed to disable or enable is not disabled a second time
+            if (std::exchange(active, std::nullopt).has_value())
+              this->m_hw.disable();
+            this->m_hw.enable(trans.m_cfg);
+            active = trans.m_cfg;
+            ++this->m_number_of_reconfigurations;
+          }
+
+          // the completion may resubmit the descriptor, so the link is read first
+          first = trans.m_next;
+          this->p_run(trans);
+          ++ret;
+        }
+      }
+    }
+    catch (...)
+    {
+      // the transactions of the drained batch that did not run fail, later submissions stay queued
+      while (first != nullptr)
+        this->p_fail(*std::exchange(first, first->m_next));
+
+      try
+      {
+        if (active.has_value())
+          this->m_hw.disable();
+      }
+      catch (...)
+      {
+      }
+      throw;
+    }
+
+    if (active.has_value())
+      this->m_hw.disable();
+    return ret;
+  }
+
+  void Transaction_Queue::wait_for_submission() const noexcept { this->m_head.wait(nullptr, std::memory_order_acquire); }
+
+  void Transaction_Queue::p_push(transaction_t& first, transaction_t& last)
+  {
+    transaction_t* head = this->m_head.load(std::memory_order_relaxed);
+    do
+    {
+      last.m_next = head;
+    } while (!this->m_head.compare_exchange_weak(head, &first, std::memory_order_release, std::memory_order_relaxed));
+
+    if (head == nullptr)
+      this->m_head.notify_all();
+  }
+
+  void Transaction_Queue::p_run(transaction_t& trans)
+  {
+    tx_segment_t const tx[] = { trans.m_tx };
+    rx_segment_t const rx[] = { trans.m_rx };
+
+    try
+    {
+      trans.m_cs->select();
+      try
+      {
+        this->m_hw.transcieve(tx, rx);
+      }
+      catch (...)
+      {
+        trans.m_cs->deselect();
+        throw;
+      }
+      trans.m_cs->deselect();
+    }
+    catch (...)
+    {
+      this->p_fail(trans);
+      throw;
+    }
+
+    // done comes first so the completion can resubmit, nothing but the completion is read afterwards
+    transaction_completion_t* const on_complete = trans.m_on_complete;
+    trans.m_status.store(transaction_status_t::done, std::memory_order_release);
+    trans.m_status.notify_all();
+    if (on_complete != nullptr)
+      (*on_complete)(trans);
+  }
+
+  void Transaction_Queue::p_fail(transaction_t& trans) noexcept
+  {
+    trans.m_status.store(transaction_status_t::failed, std::memory_order_release);
+    trans.m_status.notify_all();
+  }
+}    // namespace wlib::SPI
@@ -0,0 +1,141 @@
+#pragma once
+#ifndef WLIB_LOG_KV_STORE_HPP_INCLUDED
+#define WLIB_LOG_KV_STORE_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <wlib-memory.hpp>
+#include <wlib-storage.hpp>
+
+namespace wlib::storage
+{
+  // append only key value store. number_of_sectors sectors starting at base_add are used as a ring: new records are
+  // appended to the newest sector, compaction copies the live records of the oldest sector forward and releases it, so
+  // every sector is rewritten equally often. record crcs are seeded with the generation of their sector, stale content
+  // of a reused sector never validates and needs no erase
+  class log_kv_store_t
+  {
+  public:
+    using key_t = std::uint32_t;
+
+    struct index_entry_t
+    {
+      key_t         key     = 0;
+      std::uint32_t add     = 0;
+      std::uint16_t size    = 0;
+      bool          is_used = false;
+    };
+
+    log_kv_store_t(wlib::memory::Non_Volatile_Memory_Interface& mem,
+                   std::size_t                                  base_add,
+                   std::size_t                                  sector_size,
+                   std::size_t                                  number_of_sectors,
+                   std::span<index_entry_t>                     index);
+    log_kv_store_t(log_kv_store_t const&)            = delete;
+    log_kv_store_t(log_kv_store_t&&)                 = delete;
+    log_kv_store_t& operator=(log_kv_store_t const&) = delete;
+    log_kv_store_t& operator=(log_kv_store_t&&)      = delete;
+    virtual ~log_kv_store_t()                        = default;
+
+    bool                       contains(key_t key) const noexcept { return this->p_find(key) != nullptr; }
+    std::optional<std::size_t> get_size(key_t key) const noexcept;
+
+    // copies the value into data and returns its size, nullopt if the key is unknown or the record is corrupted
+    std::optional<std::size_t> read(key_t key, std::span<std::byte> data) const;
+    void                       write(key_t key, std::span<std::byte const> data);
+    void                       erase(key_t key);
+
+    template <typename T>
+      requires std::is_trivially_copyable_v<T>
+    std::optional<T> get(key_t key) const
+    {
+      T ret = {};
+      if (this->get_size(key) != sizeof(T) || !this->read(key, std::as_writable_bytes(std::span<T, 1>(&ret, 1))).has_value())
+        return std::nullopt;
+      return ret;
+    }
+
+    template <typename T>
+      requires std::is_trivially_copyable_v<T>
+    void set(key_t key, T const& value)
+    {
+      return this->write(key, std::as_bytes(std::span<T const, 1>(&value, 1)));
+    }
+
+    // moves at most one live record out of the oldest sector, releases the sector once it is empty. does nothing while
+    // at least a quarter of the sectors is free, returns whether work was done. meant to be called from an idle loop,
+    // write() compacts on its own when the free sectors run out
+    bool compact_step();
+
+    std::size_t   get_number_of_keys() const noexcept { return this->m_number_of_keys; }
+    std::size_t   get_number_of_free_sectors() const noexcept { return this->m_number_of_sectors - this->m_number_in_use; }
+    std::uint32_t get_generation() const noexcept { return this->m_generation; }
+
+  private:
+    struct record_t
+    {
+      key_t         key;
+      std::uint16_t size;
+      std::uint16_t flags;
+      std::uint32_t data_crc;
+    };
+
+    static constexpr std::size_t sector_header_size = 16;
+    static constexpr std::size_t record_header_size = 16;
+
+    index_entry_t const* p_find(key_t key) const noexcept;
+    index_entry_t*       p_find(key_t key) noexcept;
+    void                 p_index_set(key_t key, std::uint32_t add, std::uint16_t size);
+    void                 p_index_remove(key_t key) noexcept;
+
+    std::size_t   p_align(std::size_t size) const noexcept;
+    std::size_t   p_sector_add(std::size_t sector) const noexcept { return this->m_base + sector * this->m_sector_size; }
+    std::size_t   p_next(std::size_t sector) const noexcept { return (sector + 1) % this->m_number_of_sectors; }
+    std::uint32_t p_generation_of(std::size_t sector) const noexcept;
+
+    std::optional<std::uint32_t> p_read_sector_header(std::size_t sector) const;
+    std::optional<record_t>      p_read_record(std::size_t add, std::uint32_t generation) const;
+    std::uint32_t                p_data_crc(std::size_t add, std::size_t size) const;
+    void                         p_scan(std::size_t sector, bool is_head);
+
+    void p_append(key_t key, std::uint16_t flags, std::span<std::byte const> data);
+    void p_append_copy(record_t const& record, std::size_t data_add);
+    void p_write_record_header(std::size_t add, record_t const& record);
+    void p_reserve(std::size_t record_size, std::size_t free_sectors);
+    void p_open_next_sector();
+    void p_compact_record();
+
+    wlib::memory::Non_Volatile_Memory_Interface& m_mem;
+    std::size_t                                  m_base;
+    std::size_t                                  m_sector_size;
+    std::size_t                                  m_number_of_sectors;
+    std::span<index_entry_t>                     m_index;
+    std::size_t                                  m_number_of_keys = 0;
+    std::size_t                                  m_head           = 0;
+    std::size_t                                  m_tail           = 0;
+    std::size_t                                  m_number_in_use  = 0;
+    std::uint32_t                                m_generation     = 0;
+    std::size_t                                  m_write_offset   = 0;
+    std::size_t                                  m_compact_offset = 0;
+  };
+
+  template <std::size_t MaxKeys> class static_log_kv_store_t final
+      : private std::array<log_kv_store_t::index_entry_t, MaxKeys + MaxKeys / 2 + 1>
+      , public log_kv_store_t
+  {
+    using index_storage_t = std::array<log_kv_store_t::index_entry_t, MaxKeys + MaxKeys / 2 + 1>;
+
+  public:
+    static_log_kv_store_t(wlib::memory::Non_Volatile_Memory_Interface& mem, std::size_t base_add, std::size_t sector_size, std::size_t number_of_sectors)
+        : index_storage_t{}
+        , log_kv_store_t(mem, base_add, sector_size, number_of_sectors, std::span<index_entry_t>(*static_cast<index_storage_t*>(this)))
+    {
+    }
+  };
+}    // namespace wlib::storage
+
+#endif    // WLIB_LOG_KV_STORE_HPP_INCLUDED
@@ -2,7 +2,10 @@
 #ifndef WLIB_STORAGE_HPP_INCLUDED
 #define WLIB_STORAGE_HPP_INCLUDED
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
 #include <optional>
 #include <span>
 #include <wlib-BLOB.hpp>
@@ -12,6 +15,13 @@
 
 namespace wlib::storage
 {
+  namespace internal
+  {
+    void handle_configuration_exception();
+    void handle_full_exception();
+    void handle_buffer_exception();
+  }    // namespace internal
+
   template <typename T> class Non_Volatile_Storage_Interface
   {
   public:
@@ -26,6 +36,11 @@ namespace wlib::storage
 
 namespace wlib::storage::strategy
 {
+  enum class recovery_t
+  {
+    immediate,
+    deferred,
+  };
 
   template <typename T> class mirrow_storage_t: public wlib::storage::Non_Volatile_Storage_Interface<T>
   {
@@ -33,56 +48,121 @@ namespace wlib::storage::strategy
     using value_type = typename wlib::storage::Non_Volatile_Storage_Interface<T>::value_type;
 
   public:
+    // with recovery_t::deferred a broken mirror is only rewritten by recover() or the next save(). if both blocks lie
+    // back to back and the provided buffer holds both, they are read with a single request
     mirrow_storage_t(wlib::memory::Non_Volatile_Memory_Interface& mem,
                      std::size_t                                  blk_size,
                      std::array<std::size_t, 2> const&            addresses,
-                     Shared_Memory_Provider_Interface&            memory_provider)
+                     Shared_Memory_Provider_Interface&            memory_provider,
+                     recovery_t                                   recovery = recovery_t::immediate)
         : m_mem{ mem }
         , m_blk_sz{ blk_size }
         , m_add{ addresses }
         , m_buffer_pro(memory_provider)
     {
-      auto                 obj = this->m_buffer_pro.request();
-      std::span<std::byte> tmp = obj.get().subspan(0, this->m_blk_sz);
+      auto                       obj    = this->m_buffer_pro.request();
+      std::span<std::byte> const buffer = obj.get();
 
-      this->m_mem.read(this->m_add[0], tmp);
-      auto const val_1 = p_check(tmp);
+      std::optional<value_type> val_1 = std::nullopt;
+      std::optional<value_type> val_2 = std::nullopt;
 
-      this->m_mem.read(this->m_add[1], tmp);
-      auto const val_2 = p_check(tmp);
+      std::size_t const first = std::min(this->m_add[0], this->m_add[1]);
+      if (std::max(this->m_add[0], this->m_add[1]) - first == this->m_blk_sz && buffer.size() >= 2 * this->m_blk_sz)
+      {
+        this->m_mem.read(first, buffer.subspan(0, 2 * this->m_blk_sz));
+        val_1 = p_check(buffer.subspan(this->m_add[0] - first, this->m_blk_sz));
+        val_2 = p_check(buffer.subspan(this->m_add[1] - first, this->m_blk_sz));
+      }
+      else
+      {
+        std::span<std::byte> tmp = buffer.subspan(0, this->m_blk_sz);
+
+        this->m_mem.read(this->m_add[0], tmp);
+        val_1 = p_check(tmp);
+
+        this->m_mem.read(this->m_add[1], tmp);
+        val_2 = p_check(tmp);
+      }
 
       if (val_1.has_value())
       {
         this->m_val = val_1.value();
 
         if (val_2.has_value() && val_2.value() == this->m_val)
+        {
+          this->m_is_in_sync = true;
           return;
+        }
 
-        this->p_recover_2(tmp);
+        this->m_broken = 1;
       }
       else if (val_2.has_value())
       {
         this->m_val = val_2.value();
 
-        this->p_recover_1(tmp);
+        this->m_broken = 0;
       }
+
+      if (this->m_broken.has_value() && recovery == recovery_t::immediate)
+        this->p_recover(buffer);
+    }
+
+    // delta mode: image keeps a copy of the stored block, save() then only rewrites the alignment() sized pages that
+    // changed and patches the crc instead of recomputing it
+    mirrow_storage_t(wlib::memory::Non_Volatile_Memory_Interface& mem,
+                     std::size_t                                  blk_size,
+                     std::array<std::size_t, 2> const&            addresses,
+                     Shared_Memory_Provider_Interface&            memory_provider,
+                     std::span<std::byte>                         image,
+                     recovery_t                                   recovery = recovery_t::immediate)
+        : mirrow_storage_t(mem, blk_size, addresses, memory_provider, recovery)
+    {
+      if (image.size() < blk_size)
+        internal::handle_configuration_exception();
+
+      this->m_image = image.subspan(0, blk_size);
+      this->p_serialize(this->m_image);
     }
 
     value_type load() const override { return this->m_val; }
     void       save(value_type const& value) override
     {
       if (this->m_val == value)
+      {
+        this->recover();
         return;
+      }
 
       this->m_val = value;
 
       auto obj = this->m_buffer_pro.request();
+      if (!this->m_image.empty() && this->m_is_in_sync)
+        return this->p_save_delta(obj.get());
+
       auto tmp = this->p_serialize(obj.get());
       this->m_mem.write(this->m_add[0], tmp);
       this->m_mem.write(this->m_add[1], tmp);
       this->m_mem.flush();
+
+      if (!this->m_image.empty())
+        std::copy(tmp.begin(), tmp.end(), this->m_image.begin());
+      this->m_broken.reset();
+      this->m_is_in_sync = true;
+    }
+
+    // rewrites a mirror left broken by a deferred constructor, returns whether anything was written
+    bool recover()
+    {
+      if (!this->m_broken.has_value())
+        return false;
+
+      auto obj = this->m_buffer_pro.request();
+      this->p_recover(obj.get());
+      return true;
     }
 
+    bool needs_recovery() const noexcept { return this->m_broken.has_value(); }
+
   protected:
   private:
     constexpr std::size_t get_begin_of_crc() const { return this->m_blk_sz - sizeof(crc_t::used_type); }
@@ -111,22 +191,203 @@ namespace wlib::storage::strategy
       return blob.get_span();
     }
 
-    void p_recover(std::size_t add, std::span<std::byte> buffer)
+    void p_save_delta(std::span<std::byte> buffer)
+    {
+      std::span<std::byte> const tmp = buffer.subspan(0, this->m_blk_sz);
+      wlib::blob::MemoryBlob     blob{ tmp };
+      blob << this->m_val;
+      blob.insert_back(std::byte(0x00), this->get_begin_of_crc() - blob.get_number_of_used_bytes());
+
+      std::size_t const page = std::max<std::size_t>(this->m_mem.alignment(), 1);
+      std::size_t const end  = this->get_begin_of_crc();
+
+      // one patch per run of adjacent changed units, the cost of a patch depends on the distance to the end and not
+      // on the length of the run
+      crc_t::used_type crc = wlib::blob::ConstMemoryBlob{ this->m_image }.read<crc_t::used_type>(end);
+      for (std::size_t beg = 0; beg < end;)
+      {
+        std::size_t const len = this->p_changed_run(beg, end, tmp);
+        if (len == 0)
+        {
+          beg += std::min(page, end - beg);
+          continue;
+        }
+
+        crc = crc_t::patch(crc, this->m_image.subspan(beg, len), tmp.subspan(beg, len), end - beg - len);
+        beg += len;
+      }
+      blob.insert_back(crc);
+
+      // the changed runs, crc included, go to mirror 0 and are flushed before mirror 1 is touched. a power loss then
+      // tears at most one mirror and the other still holds a block with a matching crc
+      if (!this->p_write_runs(this->m_add[0], tmp))
+        return;
+      this->m_mem.flush();
+      this->p_write_runs(this->m_add[1], tmp);
+      this->m_mem.flush();
+
+      std::copy(tmp.begin(), tmp.end(), this->m_image.begin());
+    }
+
+    // writes the alignment() sized pages of tmp that differ from the image as contiguous runs
+    bool p_write_runs(std::size_t add, std::span<std::byte const> tmp)
+    {
+      std::size_t const page       = std::max<std::size_t>(this->m_mem.alignment(), 1);
+      bool              is_written = false;
+      for (std::size_t beg = 0; beg < this->m_blk_sz;)
+      {
+        std::size_t const len = this->p_changed_run(beg, this->m_blk_sz, tmp);
+        if (len == 0)
+        {
+          beg += std::min(page, this->m_blk_sz - beg);
+          continue;
+        }
+
+        this->m_mem.write(add + beg, tmp.subspan(beg, len));
+        is_written = true;
+        beg += len;
+      }
+      return is_written;
+    }
+
+    // length of the run of alignment units from beg on that differ between tmp and the image, 0 if the first does not
+    std::size_t p_changed_run(std::size_t beg, std::size_t end, std::span<std::byte const> tmp) const
+    {
+      std::size_t const page = std::max<std::size_t>(this->m_mem.alignment(), 1);
+      std::size_t       len  = 0;
+      while (beg + len < end)
+      {
+        std::size_t const chunk = std::min(page, end - beg - len);
+        if (std::memcmp(&tmp[beg + len], &this->m_image[beg + len], chunk) == 0)
+          break;
+        len += chunk;
+      }
+      return len;
+    }
+
+    void p_recover(std::span<std::byte> buffer)
     {
       auto tmp = this->p_serialize(buffer);
-      this->m_mem.write(add, tmp);
+      this->m_mem.write(this->m_add[this->m_broken.value()], tmp);
+      this->m_mem.flush();
+
+      this->m_broken.reset();
+      this->m_is_in_sync = true;
+    }
+
+    wlib::memory::Non_Volatile_Memory_Interface& m_mem;
+    std::size_t                                  m_blk_sz;
+    std::array<std::size_t, 2>                   m_add = {};
+    Shared_Memory_Provider_Interface&            m_buffer_pro;
+
+    value_type                 m_val        = {};
+    std::span<std::byte>       m_image      = {};
+    bool                       m_is_in_sync = false;
+    std::optional<std::size_t> m_broken     = std::nullopt;
+  };
+
+  // a/b slots carrying a generation next to the crc. save() writes only the slot holding the older generation, load
+  // uses the newest valid slot. a torn write leaves the previous value in the other slot, so one device write per save
+  // gives the same guarantee as writing both mirrors
+  template <typename T> class ping_pong_storage_t: public wlib::storage::Non_Volatile_Storage_Interface<T>
+  {
+    using crc_t        = wlib::crc::CRC_64_go_iso;
+    using generation_t = std::uint64_t;
+    using value_type   = typename wlib::storage::Non_Volatile_Storage_Interface<T>::value_type;
+
+  public:
+    ping_pong_storage_t(wlib::memory::Non_Volatile_Memory_Interface& mem,
+                        std::size_t                                  blk_size,
+                        std::array<std::size_t, 2> const&            addresses,
+                        Shared_Memory_Provider_Interface&            memory_provider)
+        : m_mem{ mem }
+        , m_blk_sz{ blk_size }
+        , m_add{ addresses }
+        , m_buffer_pro(memory_provider)
+    {
+      auto                 obj = this->m_buffer_pro.request();
+      std::span<std::byte> tmp = obj.get().subspan(0, this->m_blk_sz);
+
+      this->m_mem.read(this->m_add[0], tmp);
+      auto const slot_1 = p_check(tmp);
+
+      this->m_mem.read(this->m_add[1], tmp);
+      auto const slot_2 = p_check(tmp);
+
+      if (slot_1.has_value() && (!slot_2.has_value() || slot_2->generation < slot_1->generation))
+        this->p_select(0, slot_1.value());
+      else if (slot_2.has_value())
+        this->p_select(1, slot_2.value());
+    }
+
+    value_type load() const override { return this->m_val; }
+    void       save(value_type const& value) override
+    {
+      if (this->m_val == value)
+        return;
+
+      this->m_val = value;
+      ++this->m_generation;
+
+      std::size_t const idx = 1 - this->m_newest;
+      auto              obj = this->m_buffer_pro.request();
+      this->m_mem.write(this->m_add[idx], this->p_serialize(obj.get()));
       this->m_mem.flush();
+      this->m_newest = idx;
+    }
+
+    generation_t get_generation() const noexcept { return this->m_generation; }
+
+  private:
+    struct slot_t
+    {
+      value_type   value;
+      generation_t generation;
+    };
+
+    constexpr std::size_t get_begin_of_generation() const { return this->get_begin_of_crc() - sizeof(generation_t); }
+    constexpr std::size_t get_begin_of_crc() const { return this->m_blk_sz - sizeof(crc_t::used_type); }
+
+    void p_select(std::size_t idx, slot_t const& slot)
+    {
+      this->m_val        = slot.value;
+      this->m_generation = slot.generation;
+      this->m_newest     = idx;
+    }
+
+    std::optional<slot_t> p_check(std::span<std::byte const> buffer)
+    {
+      wlib::blob::ConstMemoryBlob blob{ buffer };
+      crc_t::used_type            crc_in   = blob.read<crc_t::used_type>(this->get_begin_of_crc());
+      crc_t::used_type            crc_calc = crc_t()(buffer.data(), this->get_begin_of_crc());
+      if (crc_in != crc_calc)
+        return std::nullopt;
+
+      slot_t ret = { {}, blob.read<generation_t>(this->get_begin_of_generation()) };
+      blob >> ret.value;
+      return ret;
     }
 
-    void p_recover_1(std::span<std::byte> buffer) { return this->p_recover(this->m_add[0], buffer); }
-    void p_recover_2(std::span<std::byte> buffer) { return this->p_recover(this->m_add[1], buffer); }
+    std::span<std::byte> p_serialize(std::span<std::byte> tmp)
+    {
+      wlib::blob::MemoryBlob blob{ tmp };
+      blob << this->m_val;
+
+      blob.insert_back(std::byte(0x00), this->get_begin_of_generation() - blob.get_number_of_used_bytes());
+      blob.insert_back(this->m_generation);
+      blob.insert_back(crc_t()(blob.get_span()));
+
+      return blob.get_span();
+    }
 
     wlib::memory::Non_Volatile_Memory_Interface& m_mem;
     std::size_t                                  m_blk_sz;
     std::array<std::size_t, 2>                   m_add = {};
     Shared_Memory_Provider_Interface&            m_buffer_pro;
 
-    value_type m_val = {};
+    value_type   m_val        = {};
+    generation_t m_generation = 0;
+    std::size_t  m_newest     = 1;
   };
 }    // namespace wlib::storage::strategy
 
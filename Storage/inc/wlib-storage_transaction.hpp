@@ -0,0 +1,111 @@
+#pragma once
+#ifndef WLIB_STORAGE_TRANSACTION_HPP_INCLUDED
+#define WLIB_STORAGE_TRANSACTION_HPP_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <wlib-memory.hpp>
+
+namespace wlib::storage
+{
+  // memory decorator collecting the writes of many storage objects. inside a transaction writes are staged in ram and
+  // flush() is ignored, reads see the staged data. the outermost commit() writes the batch in address order and
+  // flushes once. with a journal region the batch is first written there and flushed, a batch interrupted while being
+  // applied is replayed on construction, so either all or none of its writes reach the storage objects.
+  // when the staging buffers or the journal run out, the batch collected so far is committed early. a single write
+  // larger than the staging buffer or the journal can not be staged at all, it is written directly after that early
+  // commit and is neither atomic with the rest of the transaction nor protected by the journal
+  class transaction_memory_t final: public wlib::memory::Non_Volatile_Memory_Interface
+  {
+  public:
+    struct staged_write_t
+    {
+      std::size_t add    = 0;
+      std::size_t offset = 0;
+      std::size_t size   = 0;
+    };
+
+    class transaction_t
+    {
+    public:
+      explicit transaction_t(transaction_memory_t& mem) noexcept
+          : m_mem{ mem }
+      {
+        this->m_mem.begin();
+      }
+      transaction_t(transaction_t const&)            = delete;
+      transaction_t(transaction_t&&)                 = delete;
+      transaction_t& operator=(transaction_t const&) = delete;
+      transaction_t& operator=(transaction_t&&)      = delete;
+      ~transaction_t()
+      {
+        try
+        {
+          this->commit();
+        }
+        catch (...)
+        {
+        }
+      }
+
+      void commit()
+      {
+        if (!this->m_is_open)
+          return;
+        this->m_is_open = false;
+        this->m_mem.commit();
+      }
+
+    private:
+      transaction_memory_t& m_mem;
+      bool                  m_is_open = true;
+    };
+
+    transaction_memory_t(wlib::memory::Non_Volatile_Memory_Interface& mem,
+                         std::span<std::byte>                         staging,
+                         std::span<staged_write_t>                    writes,
+                         std::size_t                                  journal_add  = 0,
+                         std::size_t                                  journal_size = 0);
+    transaction_memory_t(transaction_memory_t const&)            = delete;
+    transaction_memory_t(transaction_memory_t&&)                 = delete;
+    transaction_memory_t& operator=(transaction_memory_t const&) = delete;
+    transaction_memory_t& operator=(transaction_memory_t&&)      = delete;
+    ~transaction_memory_t() override                             = default;
+
+    std::size_t capacity() const override { return this->m_mem.capacity(); }
+    std::size_t alignment() const override { return this->m_mem.alignment(); }
+    void        write(std::size_t add, std::span<std::byte const> data) override;
+    void        flush() override;
+    void        read(std::size_t add, std::span<std::byte> data) override;
+
+    // transactions nest, only the outermost commit() writes the batch
+    void begin() noexcept { ++this->m_depth; }
+    void commit();
+
+    bool        is_in_transaction() const noexcept { return this->m_depth != 0; }
+    std::size_t get_number_of_staged_writes() const noexcept { return this->m_number_of_writes; }
+
+  private:
+    bool p_fits(std::size_t size) const noexcept;
+    void p_stage(std::size_t add, std::span<std::byte const> data);
+    void p_write_through(std::size_t add, std::span<std::byte const> data);
+    void p_commit_batch();
+    void p_write_journal();
+    void p_replay_journal();
+    void p_invalidate_journal();
+
+    wlib::memory::Non_Volatile_Memory_Interface& m_mem;
+    std::span<std::byte>                         m_staging;
+    std::span<staged_write_t>                    m_writes;
+    std::size_t                                  m_journal_add;
+    std::size_t                                  m_journal_size;
+    std::size_t                                  m_depth              = 0;
+    std::size_t                                  m_number_of_writes   = 0;
+    std::size_t                                  m_staged_bytes       = 0;
+    std::size_t                                  m_journal_bytes      = 0;
+    bool                                         m_is_journal_pending = false;
+  };
+}    // namespace wlib::storage
+
+#endif    // WLIB_STORAGE_TRANSACTION_HPP_INCLUDED
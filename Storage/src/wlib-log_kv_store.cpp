@@ -0,0 +1,437 @@
+#include <wlib-log_kv_store.hpp>
+
+//
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <wlib-BLOB.hpp>
+#include <wlib-CRC.hpp>
+
+namespace wlib::storage
+{
+  namespace
+  {
+    using crc_t = wlib::crc::CRC_32;
+
+    constexpr std::uint32_t sector_magic   = 0x5756'4B31;
+    constexpr std::uint16_t flag_tombstone = 0x0001;
+    constexpr std::size_t   chunk_size     = 64;
+    constexpr std::endian   endian         = std::endian::little;
+
+    std::uint32_t header_crc(std::uint32_t generation, std::span<std::byte const> header)
+    {
+      std::array<std::byte, sizeof(generation)> seed = {};
+      wlib::blob::MemoryBlob                    blob{ seed };
+      blob.insert_back(generation, endian);
+
+      crc_t crc;
+      crc(blob.get_span());
+      return crc(header);
+    }
+
+    std::size_t home_of(log_kv_store_t::key_t key, std::size_t size) noexcept { return static_cast<std::size_t>(key * 0x9E37'79B1u) % size; }
+  }    // namespace
+
+  log_kv_store_t::log_kv_store_t(wlib::memory::Non_Volatile_Memory_Interface& mem,
+                                 std::size_t                                  base_add,
+                                 std::size_t                                  sector_size,
+                                 std::size_t                                  number_of_sectors,
+                                 std::span<index_entry_t>                     index)
+      : m_mem{ mem }
+      , m_base{ base_add }
+      , m_sector_size{ sector_size }
+      , m_number_of_sectors{ number_of_sectors }
+      , m_index{ index }
+  {
+    std::size_t const end = base_add + sector_size * number_of_sectors;
+    if (number_of_sectors < 3 || index.size() < 2 || sector_size < this->p_align(sector_header_size) + this->p_align(record_header_size) ||
+        end > mem.capacity() || end > std::numeric_limits<std::uint32_t>::max())
+      internal::handle_configuration_exception();
+
+    std::fill(this->m_index.begin(), this->m_index.end(), index_entry_t{});
+
+    bool found = false;
+    for (std::size_t sector = 0; sector < number_of_sectors; ++sector)
+    {
+      auto const generation = this->p_read_sector_header(sector);
+      if (generation.has_value() && (!found || generation.value() > this->m_generation))
+      {
+        found              = true;
+        this->m_head       = sector;
+        this->m_generation = generation.value();
+      }
+    }
+
+    if (!found)
+    {
+      this->m_head = number_of_sectors - 1;
+      this->p_open_next_sector();
+      this->m_tail = this->m_head;
+      this->m_mem.flush();
+      return;
+    }
+
+    this->m_tail          = this->m_head;
+    this->m_number_in_use = 1;
+    while (this->m_number_in_use < number_of_sectors)
+    {
+      std::size_t const prev = (this->m_tail + number_of_sectors - 1) % number_of_sectors;
+      if (this->p_read_sector_header(prev) != this->p_generation_of(this->m_tail) - 1)
+        break;
+      this->m_tail = prev;
+      ++this->m_number_in_use;
+    }
+
+    for (std::size_t i = 0, sector = this->m_tail; i < this->m_number_in_use; ++i, sector = this->p_next(sector))
+      this->p_scan(sector, sector == this->m_head);
+  }
+
+  std::optional<std::size_t> log_kv_store_t::get_size(key_t key) const noexcept
+  {
+    index_entry_t const* const entry = this->p_find(key);
+    if (entry == nullptr)
+      return std::nullopt;
+    return entry->size;
+  }
+
+  std::optional<std::size_t> log_kv_store_t::read(key_t key, std::span<std::byte> data) const
+  {
+    index_entry_t const* const entry = this->p_find(key);
+    if (entry == nullptr)
+      return std::nullopt;
+    if (data.size() < entry->size)
+      internal::handle_buffer_exception();
+
+    std::size_t const sector = (entry->add - this->m_base) / this->m_sector_size;
+    auto const        record = this->p_read_record(entry->add, this->p_generation_of(sector));
+    if (!record.has_value() || record->key != key || record->size != entry->size)
+      return std::nullopt;
+
+    std::span<std::byte> const value = data.subspan(0, entry->size);
+    this->m_mem.read(entry->add + record_header_size, value);
+    if (crc_t()(std::span<std::byte const>(value)) != record->data_crc)
+      return std::nullopt;
+    return entry->size;
+  }
+
+  void log_kv_store_t::write(key_t key, std::span<std::byte const> data)
+  {
+    if (data.size() > std::numeric_limits<std::uint16_t>::max() ||
+        this->p_align(record_header_size + data.size()) > this->m_sector_size - this->p_align(sector_header_size))
+      internal::handle_buffer_exception();
+
+    index_entry_t const* const entry = this->p_find(key);
+    if (entry == nullptr && this->m_number_of_keys + 1 >= this->m_index.size())
+      internal::handle_full_exception();
+
+    if (entry != nullptr && entry->size == data.size())
+    {
+      std::array<std::byte, chunk_size> tmp   = {};
+      bool                              equal = true;
+      for (std::size_t done = 0; equal && done < data.size(); done += chunk_size)
+      {
+        std::size_t const len = std::min(chunk_size, data.size() - done);
+        this->m_mem.read(entry->add + record_header_size + done, std::span<std::byte>(tmp.data(), len));
+        equal = std::memcmp(tmp.data(), data.data() + done, len) == 0;
+      }
+      if (equal)
+        return;
+    }
+
+    this->p_append(key, 0, data);
+    this->m_mem.flush();
+  }
+
+  void log_kv_store_t::erase(key_t key)
+  {
+    if (!this->contains(key))
+      return;
+
+    this->p_append(key, flag_tombstone, {});
+    this->m_mem.flush();
+  }
+
+  bool log_kv_store_t::compact_step()
+  {
+    if (this->m_number_in_use <= 1 || 4 * this->get_number_of_free_sectors() >= this->m_number_of_sectors)
+      return false;
+
+    this->p_compact_record();
+    this->m_mem.flush();
+    return true;
+  }
+
+  log_kv_store_t::index_entry_t const* log_kv_store_t::p_find(key_t key) const noexcept
+  {
+    std::size_t const size = this->m_index.size();
+    for (std::size_t i = 0, idx = home_of(key, size); i < size && this->m_index[idx].is_used; ++i, idx = (idx + 1) % size)
+    {
+      if (this->m_index[idx].key == key)
+        return &this->m_index[idx];
+    }
+    return nullptr;
+  }
+
+  log_kv_store_t::index_entry_t* log_kv_store_t::p_find(key_t key) noexcept
+  {
+    return const_cast<index_entry_t*>(static_cast<log_kv_store_t const*>(this)->p_find(key));
+  }
+
+  void log_kv_store_t::p_index_set(key_t key, std::uint32_t add, std::uint16_t size)
+  {
+    std::size_t const n = this->m_index.size();
+
+    std::size_t idx = home_of(key, n);
+    for (std::size_t i = 0; i < n && this->m_index[idx].is_used && this->m_index[idx].key != key; ++i)
+      idx = (idx + 1) % n;
+
+    index_entry_t& entry = this->m_index[idx];
+    if (!entry.is_used)
+    {
+      if (this->m_number_of_keys + 1 >= n)
+        internal::handle_full_exception();
+      ++this->m_number_of_keys;
+    }
+    entry = { key, add, size, true };
+  }
+
+  void log_kv_store_t::p_index_remove(key_t key) noexcept
+  {
+    index_entry_t* const entry = this->p_find(key);
+    if (entry == nullptr)
+      return;
+
+    // backward shift deletion keeps every probe sequence free of holes
+    std::size_t const n = this->m_index.size();
+    std::size_t       i = static_cast<std::size_t>(entry - this->m_index.data());
+    this->m_index[i].is_used = false;
+    --this->m_number_of_keys;
+
+    for (std::size_t j = (i + 1) % n; this->m_index[j].is_used; j = (j + 1) % n)
+    {
+      std::size_t const home     = home_of(this->m_index[j].key, n);
+      bool const        can_move = i <= j ? (home <= i || home > j) : (home <= i && home > j);
+      if (!can_move)
+        continue;
+
+      this->m_index[i]         = this->m_index[j];
+      this->m_index[j].is_used = false;
+      i                        = j;
+    }
+  }
+
+  std::size_t log_kv_store_t::p_align(std::size_t size) const noexcept
+  {
+    std::size_t const alignment = std::max<std::size_t>(this->m_mem.alignment(), 1);
+    return (size + alignment - 1) / alignment * alignment;
+  }
+
+  std::uint32_t log_kv_store_t::p_generation_of(std::size_t sector) const noexcept
+  {
+    std::size_t const distance = (this->m_head + this->m_number_of_sectors - sector) % this->m_number_of_sectors;
+    return this->m_generation - static_cast<std::uint32_t>(distance);
+  }
+
+  std::optional<std::uint32_t> log_kv_store_t::p_read_sector_header(std::size_t sector) const
+  {
+    std::array<std::byte, sector_header_size> tmp = {};
+    this->m_mem.read(this->p_sector_add(sector), tmp);
+
+    wlib::blob::ConstMemoryBlob blob{ tmp };
+    auto const                  magic      = blob.read<std::uint32_t>(0, endian);
+    auto const                  generation = blob.read<std::uint32_t>(4, endian);
+    auto const                  size       = blob.read<std::uint32_t>(8, endian);
+    auto const                  crc        = blob.read<std::uint32_t>(12, endian);
+    if (magic != sector_magic || size != this->m_sector_size || crc != header_crc(generation, std::span(tmp).first(12)))
+      return std::nullopt;
+    return generation;
+  }
+
+  std::optional<log_kv_store_t::record_t> log_kv_store_t::p_read_record(std::size_t add, std::uint32_t generation) const
+  {
+    std::array<std::byte, record_header_size> tmp = {};
+    this->m_mem.read(add, tmp);
+
+    wlib::blob::ConstMemoryBlob blob{ tmp };
+    record_t const              ret = {
+                   .key      = blob.read<std::uint32_t>(0, endian),
+                   .size     = blob.read<std::uint16_t>(4, endian),
+                   .flags    = blob.read<std::uint16_t>(6, endian),
+                   .data_crc = blob.read<std::uint32_t>(8, endian),
+    };
+    if (blob.read<std::uint32_t>(12, endian) != header_crc(generation, std::span(tmp).first(12)))
+      return std::nullopt;
+    return ret;
+  }
+
+  std::uint32_t log_kv_store_t::p_data_crc(std::size_t add, std::size_t size) const
+  {
+    std::array<std::byte, chunk_size> tmp = {};
+    crc_t                             crc;
+    for (std::size_t done = 0; done < size; done += chunk_size)
+    {
+      std::span<std::byte> const chunk{ tmp.data(), std::min(chunk_size, size - done) };
+      this->m_mem.read(add + done, chunk);
+      crc(std::span<std::byte const>(chunk));
+    }
+    return crc.get();
+  }
+
+  void log_kv_store_t::p_scan(std::size_t sector, bool is_head)
+  {
+    std::size_t const   base       = this->p_sector_add(sector);
+    std::uint32_t const generation = this->p_generation_of(sector);
+
+    std::size_t offset = this->p_align(sector_header_size);
+    while (offset + record_header_size <= this->m_sector_size)
+    {
+      auto const record = this->p_read_record(base + offset, generation);
+      if (!record.has_value())
+        break;
+
+      std::size_t const size = this->p_align(record_header_size + record->size);
+      if (offset + size > this->m_sector_size)
+        break;
+      // only the newest sector can end with a torn record, older sectors were complete before the next was opened
+      if (is_head && this->p_data_crc(base + offset + record_header_size, record->size) != record->data_crc)
+        break;
+
+      if ((record->flags & flag_tombstone) != 0)
+        this->p_index_remove(record->key);
+      else
+        this->p_index_set(record->key, static_cast<std::uint32_t>(base + offset), record->size);
+      offset += size;
+    }
+
+    if (is_head)
+      this->m_write_offset = offset;
+  }
+
+  void log_kv_store_t::p_append(key_t key, std::uint16_t flags, std::span<std::byte const> data)
+  {
+    std::size_t const size = this->p_align(record_header_size + data.size());
+    this->p_reserve(size, 2);
+
+    std::size_t const add = this->p_sector_add(this->m_head) + this->m_write_offset;
+    this->p_write_record_header(add, { key, static_cast<std::uint16_t>(data.size()), flags, crc_t()(data) });
+    if (!data.empty())
+      this->m_mem.write(add + record_header_size, data);
+    this->m_write_offset += size;
+
+    if ((flags & flag_tombstone) != 0)
+      this->p_index_remove(key);
+    else
+      this->p_index_set(key, static_cast<std::uint32_t>(add), static_cast<std::uint16_t>(data.size()));
+  }
+
+  void log_kv_store_t::p_append_copy(record_t const& record, std::size_t data_add)
+  {
+    // the live records of one sector always fit into the rest of the head plus one fresh sector
+    std::size_t const size = this->p_align(record_header_size + record.size);
+    this->p_reserve(size, 0);
+
+    std::size_t const add = this->p_sector_add(this->m_head) + this->m_write_offset;
+    this->p_write_record_header(add, record);
+
+    std::array<std::byte, chunk_size> tmp = {};
+    for (std::size_t done = 0; done < record.size; done += chunk_size)
+    {
+      std::span<std::byte> const chunk{ tmp.data(), std::min<std::size_t>(chunk_size, record.size - done) };
+      this->m_mem.read(data_add + done, chunk);
+      this->m_mem.write(add + record_header_size + done, chunk);
+    }
+    this->m_write_offset += size;
+
+    this->p_index_set(record.key, static_cast<std::uint32_t>(add), record.size);
+  }
+
+  void log_kv_store_t::p_write_record_header(std::size_t add, record_t const& record)
+  {
+    std::array<std::byte, record_header_size> tmp = {};
+    wlib::blob::MemoryBlob                     blob{ tmp };
+    blob.insert_back(record.key, endian);
+    blob.insert_back(record.size, endian);
+    blob.insert_back(record.flags, endian);
+    blob.insert_back(record.data_crc, endian);
+    blob.insert_back(header_crc(this->m_generation, blob.get_span()), endian);
+    this->m_mem.write(add, blob.get_span());
+  }
+
+  void log_kv_store_t::p_reserve(std::size_t record_size, std::size_t free_sectors)
+  {
+    if (this->m_write_offset + record_size <= this->m_sector_size)
+      return;
+
+    // one free sector stays reserved for the records moved by compaction
+    std::size_t released = 0;
+    while (this->get_number_of_free_sectors() < free_sectors)
+    {
+      std::size_t const in_use = this->m_number_in_use;
+      this->p_compact_record();
+      if (this->m_number_in_use < in_use && ++released > this->m_number_of_sectors)
+        internal::handle_full_exception();
+    }
+
+    if (this->m_write_offset + record_size <= this->m_sector_size)
+      return;
+    if (this->get_number_of_free_sectors() == 0)
+      internal::handle_full_exception();
+    this->p_open_next_sector();
+  }
+
+  void log_kv_store_t::p_open_next_sector()
+  {
+    this->m_head = this->p_next(this->m_head);
+    ++this->m_generation;
+    ++this->m_number_in_use;
+
+    std::array<std::byte, sector_header_size> tmp = {};
+    wlib::blob::MemoryBlob                     blob{ tmp };
+    blob.insert_back(sector_magic, endian);
+    blob.insert_back(this->m_generation, endian);
+    blob.insert_back(static_cast<std::uint32_t>(this->m_sector_size), endian);
+    blob.insert_back(header_crc(this->m_generation, blob.get_span()), endian);
+    this->m_mem.write(this->p_sector_add(this->m_head), blob.get_span());
+
+    this->m_write_offset = this->p_align(sector_header_size);
+  }
+
+  void log_kv_store_t::p_compact_record()
+  {
+    std::size_t const   base       = this->p_sector_add(this->m_tail);
+    std::uint32_t const generation = this->p_generation_of(this->m_tail);
+
+    std::size_t offset = std::max(this->m_compact_offset, this->p_align(sector_header_size));
+    while (offset + record_header_size <= this->m_sector_size)
+    {
+      auto const record = this->p_read_record(base + offset, generation);
+      if (!record.has_value())
+        break;
+
+      std::size_t const size = this->p_align(record_header_size + record->size);
+      if (offset + size > this->m_sector_size)
+        break;
+
+      std::size_t const          add   = base + offset;
+      index_entry_t const* const entry = this->p_find(record->key);
+      offset += size;
+      this->m_compact_offset = offset;
+
+      if ((record->flags & flag_tombstone) == 0 && entry != nullptr && entry->add == add)
+      {
+        return this->p_append_copy(record.value(), add + record_header_size);
+      }
+    }
+
+    // the copies have to be durable before the sector holding the originals is released
+    std::array<std::byte, sector_header_size> const invalid = {};
+    this->m_mem.flush();
+    this->m_mem.write(base, invalid);
+    this->m_mem.flush();
+
+    this->m_tail = this->p_next(this->m_tail);
+    --this->m_number_in_use;
+    this->m_compact_offset = 0;
+  }
+}    // namespace wlib::storage
@@ -1,2 +1,11 @@
 #include <wlib-storage.hpp>
 
+//
+#include <stdexcept>
+
+namespace wlib::storage
+{
+  void internal::handle_configuration_exception() { throw std::invalid_argument("invalid storage layout"); }
+  void internal::handle_full_exception() { throw std::length_error("storage is full"); }
+  void internal::handle_buffer_exception() { throw std::length_error("buffer does not fit the value"); }
+}    // namespace wlib::storage
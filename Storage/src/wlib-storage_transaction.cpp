@@ -0,0 +1,256 @@
+#include <wlib-storage_transaction.hpp>
+
+//
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <wlib-BLOB.hpp>
+#include <wlib-CRC.hpp>
+#include <wlib-storage.hpp>
+
+namespace wlib::storage
+{
+  namespace
+  {
+    using crc_t = wlib::crc::CRC_64_go_iso;
+
+    constexpr std::uint32_t journal_magic = 0x574A'524E;
+    constexpr std::size_t   header_size   = 24;    // magic, count, payload size, crc
+    constexpr std::size_t   entry_size    = 12;    // add, size
+    constexpr std::size_t   chunk_size    = 64;
+    constexpr std::endian   endian        = std::endian::little;
+  }    // namespace
+
+  transaction_memory_t::transaction_memory_t(wlib::memory::Non_Volatile_Memory_Interface& mem,
+                                             std::span<std::byte>                         staging,
+                                             std::span<staged_write_t>                    writes,
+                                             std::size_t                                  journal_add,
+                                             std::size_t                                  journal_size)
+      : m_mem{ mem }
+      , m_staging{ staging }
+      , m_writes{ writes }
+      , m_journal_add{ journal_add }
+      , m_journal_size{ journal_size }
+      , m_journal_bytes{ header_size }
+  {
+    if (journal_size != 0 && (journal_size <= header_size + entry_size || journal_add > mem.capacity() || journal_size > mem.capacity() - journal_add))
+      internal::handle_configuration_exception();
+
+    if (journal_size != 0)
+      this->p_replay_journal();
+  }
+
+  void transaction_memory_t::write(std::size_t add, std::span<std::byte const> data)
+  {
+    if (add > this->capacity() || data.size() > this->capacity() - add)
+      wlib::memory::internal::handle_range_exception();
+
+    if (this->is_in_transaction())
+      return this->p_stage(add, data);
+
+    this->p_write_through(add, data);
+  }
+
+  void transaction_memory_t::flush()
+  {
+    if (!this->is_in_transaction())
+      this->m_mem.flush();
+  }
+
+  void transaction_memory_t::read(std::size_t add, std::span<std::byte> data)
+  {
+    this->m_mem.read(add, data);
+
+    std::size_t const end = add + data.size();
+    for (staged_write_t const& staged : this->m_writes.first(this->m_number_of_writes))
+    {
+      std::size_t const beg = std::max(add, staged.add);
+      std::size_t const lst = std::min(end, staged.add + staged.size);
+      if (beg < lst)
+        std::memcpy(&data[beg - add], &this->m_staging[staged.offset + beg - staged.add], lst - beg);
+    }
+  }
+
+  void transaction_memory_t::commit()
+  {
+    if (this->m_depth == 0 || --this->m_depth != 0)
+      return;
+    this->p_commit_batch();
+  }
+
+  bool transaction_memory_t::p_fits(std::size_t size) const noexcept
+  {
+    if (this->m_number_of_writes == this->m_writes.size() || size > this->m_staging.size() - this->m_staged_bytes)
+      return false;
+    return this->m_journal_size == 0 || this->m_journal_bytes + entry_size + size <= this->m_journal_size;
+  }
+
+  void transaction_memory_t::p_stage(std::size_t add, std::span<std::byte const> data)
+  {
+    if (!this->p_fits(data.size()))
+    {
+      this->p_commit_batch();
+      if (!this->p_fits(data.size()))
+        return this->p_write_through(add, data);
+    }
+
+    // overlapping staged writes take over the new bytes, so the batch can be applied in any order
+    bool              is_covered = false;
+    std::size_t const end        = add + data.size();
+    for (staged_write_t const& staged : this->m_writes.first(this->m_number_of_writes))
+    {
+      std::size_t const beg = std::max(add, staged.add);
+      std::size_t const lst = std::min(end, staged.add + staged.size);
+      if (beg >= lst)
+        continue;
+
+      std::memcpy(&this->m_staging[staged.offset + beg - staged.add], &data[beg - add], lst - beg);
+      is_covered = is_covered || (beg == add && lst == end);
+    }
+    if (is_covered)
+      return;
+
+    std::memcpy(&this->m_staging[this->m_staged_bytes], data.data(), data.size());
+    this->m_writes[this->m_number_of_writes++] = { add, this->m_staged_bytes, data.size() };
+    this->m_staged_bytes += data.size();
+    this->m_journal_bytes += entry_size + data.size();
+  }
+
+  void transaction_memory_t::p_write_through(std::size_t add, std::span<std::byte const> data)
+  {
+    // the journal of the last batch must not be replayed over newer data
+    if (this->m_is_journal_pending)
+    {
+      this->m_mem.flush();
+      this->m_is_journal_pending = false;
+    }
+    this->m_mem.write(add, data);
+  }
+
+  void transaction_memory_t::p_commit_batch()
+  {
+    if (this->m_number_of_writes == 0)
+      return;
+
+    std::span<staged_write_t> const writes = this->m_writes.first(this->m_number_of_writes);
+    std::sort(writes.begin(), writes.end(), [](staged_write_t const& lhs, staged_write_t const& rhs) { return lhs.add < rhs.add; });
+
+    if (this->m_journal_size != 0)
+    {
+      this->p_write_journal();
+      this->m_mem.flush();
+    }
+
+    for (std::size_t i = 0; i < writes.size();)
+    {
+      // neighbours staged back to back go out as one device write
+      std::size_t j = i + 1;
+      while (j < writes.size() && writes[j].add == writes[j - 1].add + writes[j - 1].size && writes[j].offset == writes[j - 1].offset + writes[j - 1].size)
+        ++j;
+
+      std::size_t const size = writes[j - 1].offset + writes[j - 1].size - writes[i].offset;
+      this->m_mem.write(writes[i].add, this->m_staging.subspan(writes[i].offset, size));
+      i = j;
+    }
+    this->m_mem.flush();
+
+    this->m_number_of_writes = 0;
+    this->m_staged_bytes     = 0;
+    this->m_journal_bytes    = header_size;
+
+    if (this->m_journal_size != 0)
+    {
+      // becomes durable with the next flush
+      this->p_invalidate_journal();
+      this->m_is_journal_pending = true;
+    }
+  }
+
+  void transaction_memory_t::p_write_journal()
+  {
+    crc_t                                 crc;
+    std::array<std::byte, header_size>    header = {};
+    std::array<std::byte, entry_size>     entry  = {};
+    std::span<staged_write_t const> const writes = this->m_writes.first(this->m_number_of_writes);
+    wlib::blob::MemoryBlob                blob{ header };
+
+    blob.insert_back(journal_magic, endian);
+    blob.insert_back(static_cast<std::uint32_t>(writes.size()), endian);
+    blob.insert_back(static_cast<std::uint64_t>(this->m_journal_bytes - header_size), endian);
+    crc(blob.get_span());
+
+    std::size_t pos = this->m_journal_add + header_size;
+    for (staged_write_t const& staged : writes)
+    {
+      wlib::blob::MemoryBlob desc{ entry };
+      desc.insert_back(static_cast<std::uint64_t>(staged.add), endian);
+      desc.insert_back(static_cast<std::uint32_t>(staged.size), endian);
+
+      std::span<std::byte const> const data = this->m_staging.subspan(staged.offset, staged.size);
+      crc(desc.get_span());
+      crc(data);
+
+      this->m_mem.write(pos, desc.get_span());
+      this->m_mem.write(pos + entry_size, data);
+      pos += entry_size + staged.size;
+    }
+
+    blob.insert_back(crc.get(), endian);
+    this->m_mem.write(this->m_journal_add, blob.get_span());
+  }
+
+  void transaction_memory_t::p_replay_journal()
+  {
+    std::array<std::byte, header_size> header = {};
+    this->m_mem.read(this->m_journal_add, header);
+
+    wlib::blob::ConstMemoryBlob blob{ header };
+    auto const                  magic = blob.read<std::uint32_t>(0, endian);
+    auto const                  count = blob.read<std::uint32_t>(4, endian);
+    auto const                  size  = blob.read<std::uint64_t>(8, endian);
+    if (magic != journal_magic || size > this->m_journal_size - header_size)
+      return;
+
+    crc_t                             crc;
+    std::array<std::byte, chunk_size> tmp = {};
+    crc(std::span<std::byte const>(header).first(16));
+    for (std::size_t done = 0; done < size; done += chunk_size)
+    {
+      std::span<std::byte> const chunk{ tmp.data(), std::min<std::size_t>(chunk_size, size - done) };
+      this->m_mem.read(this->m_journal_add + header_size + done, chunk);
+      crc(std::span<std::byte const>(chunk));
+    }
+    if (crc.get() != blob.read<std::uint64_t>(16, endian))
+      return;
+
+    std::size_t pos = this->m_journal_add + header_size;
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+      std::array<std::byte, entry_size> entry = {};
+      this->m_mem.read(pos, entry);
+
+      wlib::blob::ConstMemoryBlob desc{ entry };
+      auto const                  add = desc.read<std::uint64_t>(0, endian);
+      auto const                  len = desc.read<std::uint32_t>(8, endian);
+      pos += entry_size;
+
+      for (std::size_t done = 0; done < len; done += chunk_size)
+      {
+        std::span<std::byte> const chunk{ tmp.data(), std::min<std::size_t>(chunk_size, len - done) };
+        this->m_mem.read(pos + done, chunk);
+        this->m_mem.write(static_cast<std::size_t>(add) + done, chunk);
+      }
+      pos += len;
+    }
+    this->m_mem.flush();
+
+    this->p_invalidate_journal();
+    this->m_mem.flush();
+  }
+
+  void transaction_memory_t::p_invalidate_journal()
+  {
+    std::array<std::byte, header_size> const invalid = {};
+    this->m_mem.write(this->m_journal_add, invalid);
+  }
+}    // namespace wlib::storage
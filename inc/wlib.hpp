@@ -7,14 +7,29 @@
 #include <wlib-BLOB.hpp>
 #include <wlib-Callback.hpp>
 #include <wlib-Publisher.hpp>
+#include <wlib-Async_Publisher.hpp>
+#include <wlib-Topic_Publisher.hpp>
 #include <wlib-Container.hpp>
 #include <wlib-SPI_Interface.hpp>
+#include <wlib-SPI_Transaction_Queue.hpp>
+#include <wlib-SPI_Bus_Arbiter.hpp>
+#include <wlib-SPI_Simulation.hpp>
+#include <wlib-SPI_Spidev.hpp>
 #include <wlib-io.hpp>
 #include <wlib-StringSink.hpp>
 #include <wlib-StringBuilder.hpp>
 #include <wlib-memory.hpp>
+#include <wlib-memory_mapped_file.hpp>
+#include <wlib-memory_cache.hpp>
+#include <wlib-memory_async.hpp>
+#include <wlib-memory_resource.hpp>
+#include <wlib-memory_spi_nor.hpp>
 #include <wlib-storage.hpp>
+#include <wlib-log_kv_store.hpp>
+#include <wlib-storage_transaction.hpp>
 #include <wlib-Provider_Interface.hpp>
+#include <wlib-Pool_Provider.hpp>
+#include <wlib-Lock_Provider.hpp>
 
 //#include <wlib_LED_abstraction.hpp>
 //#include <wlib_MPSC.hpp>